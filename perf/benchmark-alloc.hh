@@ -0,0 +1,104 @@
+/*
+ * Heap instrumentation shared by the benchmarks.
+ */
+#ifndef BENCHMARK_ALLOC_HH
+#define BENCHMARK_ALLOC_HH
+
+#include <atomic>
+#include <cstdlib>
+
+/* Count heap allocations and track live heap bytes by interposing malloc
+ * and friends.  Only done with glibc, which exposes the underlying
+ * allocator under the __libc_ names; elsewhere HAVE_ALLOC_COUNTING and
+ * HAVE_HEAP_TRACKING are left undefined and benchmarks leave out their
+ * allocation counters. */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#include <malloc.h>
+#include <cerrno>
+#define HAVE_ALLOC_COUNTING 1
+#define HAVE_HEAP_TRACKING 1
+
+static std::atomic<unsigned long> num_allocs;
+static std::atomic<long> heap_in_use;
+static std::atomic<long> heap_peak;
+
+static inline void *
+track_alloc (void *p)
+{
+  num_allocs.fetch_add (1, std::memory_order_relaxed);
+  if (!p) return p;
+  long size = malloc_usable_size (p);
+  long in_use = heap_in_use.fetch_add (size, std::memory_order_relaxed) + size;
+  long peak = heap_peak.load (std::memory_order_relaxed);
+  while (in_use > peak &&
+	 !heap_peak.compare_exchange_weak (peak, in_use, std::memory_order_relaxed))
+    ;
+  return p;
+}
+
+static inline void
+track_free (void *p)
+{
+  if (p)
+    heap_in_use.fetch_sub (malloc_usable_size (p), std::memory_order_relaxed);
+}
+
+extern "C" {
+void *__libc_malloc (size_t size);
+void *__libc_calloc (size_t nmemb, size_t size);
+void *__libc_realloc (void *ptr, size_t size);
+void *__libc_memalign (size_t alignment, size_t size);
+void __libc_free (void *ptr);
+
+void *malloc (size_t size)
+{
+  return track_alloc (__libc_malloc (size));
+}
+void *calloc (size_t nmemb, size_t size)
+{
+  return track_alloc (__libc_calloc (nmemb, size));
+}
+void *realloc (void *ptr, size_t size)
+{
+  long old_size = ptr ? malloc_usable_size (ptr) : 0;
+  void *p = __libc_realloc (ptr, size);
+  if (!p && size)
+    return p;
+  heap_in_use.fetch_sub (old_size, std::memory_order_relaxed);
+  return track_alloc (p);
+}
+void *memalign (size_t alignment, size_t size)
+{
+  return track_alloc (__libc_memalign (alignment, size));
+}
+void *aligned_alloc (size_t alignment, size_t size)
+{
+  return track_alloc (__libc_memalign (alignment, size));
+}
+int posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+  void *p = track_alloc (__libc_memalign (alignment, size));
+  if (!p) return ENOMEM;
+  *memptr = p;
+  return 0;
+}
+void free (void *ptr)
+{
+  track_free (ptr);
+  __libc_free (ptr);
+}
+}
+
+/* Returns the peak heap use above the current level while running func. */
+template <typename Func>
+static long
+measure_peak_heap (Func func)
+{
+  long base = heap_in_use.load (std::memory_order_relaxed);
+  heap_peak.store (base, std::memory_order_relaxed);
+  func ();
+  return heap_peak.load (std::memory_order_relaxed) - base;
+}
+#endif
+
+#endif /* BENCHMARK_ALLOC_HH */
@@ -42,6 +42,7 @@ enum operation_t
   glyph_h_advances,
   glyph_extents,
   draw_glyph,
+  draw_glyph_random_coords,
   paint_glyph,
   load_face_and_shape,
 };
@@ -193,6 +194,32 @@ static void BM_Font (benchmark::State &state,
       hb_draw_funcs_destroy (draw_funcs);
       break;
     }
+    case draw_glyph_random_coords:
+    {
+      /* Draws every glyph at a different random location each round, so
+       * that the time is dominated by applying variation deltas. */
+      unsigned num_axes = hb_ot_var_get_axis_count (hb_font_get_face (font));
+      int *coords = (int *) calloc (num_axes, sizeof (int));
+      unsigned seed = 1;
+
+      hb_draw_funcs_t *draw_funcs = _draw_funcs_create ();
+      for (auto _ : state)
+      {
+	for (unsigned i = 0; i < num_axes; i++)
+	{
+	  seed = seed * 1103515245 + 12345;
+	  coords[i] = (int) ((seed >> 16) % 32769) - 16384;
+	}
+	hb_font_set_var_coords_normalized (font, coords, num_axes);
+
+	float i = 0;
+	for (unsigned gid = 0; gid < num_glyphs; ++gid)
+	  hb_font_draw_glyph (font, gid, draw_funcs, &i);
+      }
+      hb_draw_funcs_destroy (draw_funcs);
+      free (coords);
+      break;
+    }
     case paint_glyph:
     {
       hb_paint_funcs_t *paint_funcs = hb_paint_funcs_create ();
@@ -276,6 +303,8 @@ static void test_operation (operation_t op,
     for (int variable = 0; variable < int (test_input.is_variable) + 1; variable++)
     {
       bool is_var = (bool) variable;
+      if (op == draw_glyph_random_coords && !is_var)
+	continue;
 
       test_backend (HARFBUZZ, "hb", is_var, op, op_name, time_unit, test_input);
 #ifdef HAVE_FREETYPE
@@ -306,6 +335,7 @@ int main(int argc, char** argv)
   TEST_OPERATION (glyph_h_advances, benchmark::kMicrosecond);
   TEST_OPERATION (glyph_extents, benchmark::kMicrosecond);
   TEST_OPERATION (draw_glyph, benchmark::kMicrosecond);
+  TEST_OPERATION (draw_glyph_random_coords, benchmark::kMicrosecond);
   TEST_OPERATION (paint_glyph, benchmark::kMillisecond);
   TEST_OPERATION (load_face_and_shape, benchmark::kMicrosecond);
 
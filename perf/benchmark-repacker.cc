@@ -0,0 +1,253 @@
+/*
+ * Benchmarks for the repacker: the topological sort that is redone after
+ * every overflow resolution round, and whole overflow resolution.
+ */
+#include "benchmark/benchmark.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+#include "hb-repacker.hh"
+
+using graph::graph_t;
+
+/* A GSUB-like object graph: a lookup list pointing at lookups, each
+ * pointing at a handful of subtables, which share their coverage tables
+ * with the neighbouring subtables.  All offsets are 16 bit. */
+struct test_graph_t
+{
+  test_graph_t (unsigned num_lookups,
+                unsigned subtables_per_lookup = 8,
+                unsigned subtables_per_coverage = 4,
+                unsigned coverage_size = 200)
+  {
+    unsigned num_subtables = num_lookups * subtables_per_lookup;
+    unsigned num_coverages = (num_subtables + subtables_per_coverage - 1) / subtables_per_coverage;
+
+    packed.push (nullptr);
+    for (unsigned i = 0; i < num_coverages; i++)
+      add_object (coverage_size);
+
+    for (unsigned i = 0; i < num_subtables; i++)
+    {
+      auto *obj = add_object (32);
+      add_link (obj, 2, 1 + i / subtables_per_coverage);
+    }
+
+    for (unsigned i = 0; i < num_lookups; i++)
+    {
+      auto *obj = add_object (6 + 4 * subtables_per_lookup);
+      for (unsigned j = 0; j < subtables_per_lookup; j++)
+        add_link (obj, 6 + 4 * j, 1 + num_coverages + i * subtables_per_lookup + j, 4);
+    }
+
+    auto *obj = add_object (2 + 2 * num_lookups);
+    for (unsigned i = 0; i < num_lookups; i++)
+      add_link (obj, 2 + 2 * i, 1 + num_coverages + num_subtables + i);
+
+    for (unsigned i = 1; i < packed.length; i++)
+      packed[i] = &objects[i - 1];
+  }
+
+  ~test_graph_t ()
+  {
+    for (char *buffer : buffers)
+      hb_free (buffer);
+  }
+
+  hb_serialize_context_t::object_t *add_object (unsigned size)
+  {
+    char *buffer = (char *) hb_calloc (size, 1);
+    buffers.push (buffer);
+
+    auto *obj = objects.push ();
+    obj->head = buffer;
+    obj->tail = buffer + size;
+    packed.push (nullptr);
+    return obj;
+  }
+
+  void add_link (hb_serialize_context_t::object_t *obj,
+                 unsigned position,
+                 unsigned objidx,
+                 unsigned width = 2)
+  {
+    auto *link = obj->real_links.push ();
+    link->width = width;
+    link->is_signed = 0;
+    link->whence = 0;
+    link->bias = 0;
+    link->position = position;
+    link->objidx = objidx;
+  }
+
+  hb_vector_t<char *> buffers;
+  hb_vector_t<hb_serialize_context_t::object_t> objects;
+  hb_vector_t<const hb_serialize_context_t::object_t *> packed;
+};
+
+/* Duplicates the last placed shared object for its last placed parent,
+ * the way the furthest overflow would be resolved. */
+static bool
+duplicate_last_shared (graph_t &graph)
+{
+  for (unsigned i = 0; i < graph.vertices_.length; i++)
+  {
+    const auto &v = graph.vertices_[i];
+    if (!v.is_shared ()) continue;
+
+    unsigned parent = (unsigned) -1;
+    for (unsigned p : v.parents_iter ())
+      parent = hb_min (parent, p);
+    return graph.duplicate (parent, i) != (unsigned) -1;
+  }
+  return false;
+}
+
+/* Sorts the graph after each of a number of duplication rounds, the way
+ * hb_resolve_graph_overflows () does. */
+static void BM_sort (benchmark::State &state, bool incremental)
+{
+  test_graph_t objects (state.range (0));
+  const unsigned rounds = 16;
+
+  for (auto _ : state)
+  {
+    graph_t graph (objects.packed);
+    graph.sort_shortest_distance ();
+
+    std::chrono::duration<double> elapsed {};
+    for (unsigned i = 0; i < rounds; i++)
+    {
+      if (!duplicate_last_shared (graph)) break;
+
+      auto start = std::chrono::steady_clock::now ();
+      if (incremental)
+        graph.sort_shortest_distance_incremental ();
+      else
+        graph.sort_shortest_distance ();
+      elapsed += std::chrono::steady_clock::now () - start;
+    }
+    assert (!graph.in_error ());
+
+    state.SetIterationTime (elapsed.count ());
+  }
+
+  state.counters["vertices"] = benchmark::Counter (objects.objects.length);
+}
+BENCHMARK_CAPTURE (BM_sort, full, false)
+    ->Range (1 << 6, 1 << 12)
+    ->UseManualTime ()
+    ->Unit (benchmark::kMicrosecond);
+BENCHMARK_CAPTURE (BM_sort, incremental, true)
+    ->Range (1 << 6, 1 << 12)
+    ->UseManualTime ()
+    ->Unit (benchmark::kMicrosecond);
+
+/* Resolves the overflows of a graph whose coverage tables don't fit in
+ * 16 bit offsets without many rounds of duplicating them. */
+static void BM_resolve_overflows (benchmark::State &state)
+{
+  test_graph_t objects (state.range (0), 8, 4, 1000);
+  const unsigned max_rounds = 1000;
+
+  for (auto _ : state)
+  {
+    hb_blob_t *blob = hb_resolve_overflows (objects.packed, HB_TAG_NONE, max_rounds);
+    assert (blob);
+    hb_blob_destroy (blob);
+  }
+
+  state.counters["vertices"] = benchmark::Counter (objects.objects.length);
+}
+BENCHMARK (BM_resolve_overflows)
+    ->Range (1 << 6, 1 << 8)
+    ->Unit (benchmark::kMillisecond);
+
+#define REPACK_TESTS_BASE_PATH "test/subset/data/repack_tests/"
+#define SUBSET_FONT_BASE_PATH "test/subset/data/fonts/"
+
+static const char *repack_tests[] =
+{
+  "basic.tests",
+  "prioritization.tests",
+  "advanced_prioritization.tests",
+  "table_duplication.tests",
+  "isolation.tests",
+  "space_splitting.tests",
+};
+
+static void
+repack_stage (const hb_subset_stage_info_t *info, void *user_data)
+{
+  if (info->stage == HB_SUBSET_STAGE_REPACK && info->end_ns)
+    *(double *) user_data += (info->end_ns - info->start_ns) / 1e9;
+}
+
+/* Subsets a font the way test/subset/run-repack-tests.py does, reporting
+ * the time spent repacking separately. */
+static void BM_repack_test (benchmark::State &state, const char *test_path)
+{
+  /* The first line names the font, the rest are code points in hex. */
+  FILE *f = fopen (test_path, "r");
+  assert (f);
+  char line[256];
+  char font_path[sizeof (SUBSET_FONT_BASE_PATH) + sizeof (line)] = SUBSET_FONT_BASE_PATH;
+  if (!fgets (line, sizeof (line), f))
+    line[0] = '\0';
+  line[strcspn (line, "\r\n")] = '\0';
+  strcat (font_path, line);
+
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  assert (input);
+  hb_set_t *unicodes = hb_subset_input_unicode_set (input);
+  while (fgets (line, sizeof (line), f))
+    if (*line != '\n')
+      hb_set_add (unicodes, strtoul (line, nullptr, 16));
+  fclose (f);
+
+  hb_set_t *drop_tables = hb_subset_input_set (input, HB_SUBSET_SETS_DROP_TABLE_TAG);
+  hb_set_del (drop_tables, HB_OT_TAG_GSUB);
+  hb_set_del (drop_tables, HB_OT_TAG_GPOS);
+  hb_set_del (drop_tables, HB_OT_TAG_GDEF);
+
+  double repack_seconds = 0.;
+  hb_subset_input_set_stage_func (input, repack_stage, &repack_seconds);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+
+  for (auto _ : state)
+  {
+    hb_face_t *subset = hb_subset_or_fail (face, input);
+    assert (subset);
+    hb_face_destroy (subset);
+  }
+
+  state.counters["repack"] = benchmark::Counter (repack_seconds * 1e3 / state.iterations ());
+
+  hb_face_destroy (face);
+  hb_subset_input_destroy (input);
+}
+
+int main (int argc, char **argv)
+{
+  benchmark::Initialize (&argc, argv);
+
+  for (const char *test : repack_tests)
+  {
+    char test_path[1024] = REPACK_TESTS_BASE_PATH;
+    strcat (test_path, test);
+    char name[1024] = "BM_repack_test/";
+    strcat (name, test);
+
+    benchmark::RegisterBenchmark (name, BM_repack_test, strdup (test_path))
+        ->Unit (benchmark::kMillisecond);
+  }
+
+  benchmark::RunSpecifiedBenchmarks ();
+  benchmark::Shutdown ();
+}
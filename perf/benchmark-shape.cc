@@ -1,11 +1,13 @@
 #include "benchmark/benchmark.h"
 #include <cstring>
+#include <cstdlib>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
 #include <cassert>
+#include <cstdio>
 
 #include "hb.h"
 #include "hb-ot.h"
@@ -13,43 +15,92 @@
 #include "hb-ft.h"
 #endif
 
+#include "benchmark-alloc.hh"
+
 #define SUBSET_FONT_BASE_PATH "test/subset/data/fonts/"
 
+/* Fonts under perf/fonts/ that are not in the tree (Hangul, CJK, and
+ * color emoji fonts are too large to check in) are skipped when missing;
+ * drop them in to include those scripts in the run. */
+
 struct test_input_t
 {
+  const char *script;
   const char *font_path;
   const char *text_path;
   bool is_variable;
 } default_tests[] =
 {
 
-  {"perf/fonts/NotoNastaliqUrdu-Regular.ttf",
+  {"Arabic",
+   "perf/fonts/NotoNastaliqUrdu-Regular.ttf",
    "perf/texts/fa-thelittleprince.txt",
    false},
 
-  {"perf/fonts/NotoNastaliqUrdu-Regular.ttf",
+  {"Arabic",
+   "perf/fonts/NotoNastaliqUrdu-Regular.ttf",
    "perf/texts/fa-words.txt",
    false},
 
-  {"perf/fonts/Amiri-Regular.ttf",
+  {"Arabic",
+   "perf/fonts/Amiri-Regular.ttf",
    "perf/texts/fa-thelittleprince.txt",
    false},
 
-  {SUBSET_FONT_BASE_PATH "NotoSansDevanagari-Regular.ttf",
+  {"Devanagari",
+   SUBSET_FONT_BASE_PATH "NotoSansDevanagari-Regular.ttf",
    "perf/texts/hi-words.txt",
    false},
 
-  {"perf/fonts/Roboto-Regular.ttf",
+  {"Latin",
+   "perf/fonts/Roboto-Regular.ttf",
    "perf/texts/en-thelittleprince.txt",
    false},
 
-  {"perf/fonts/Roboto-Regular.ttf",
+  {"Latin",
+   "perf/fonts/Roboto-Regular.ttf",
    "perf/texts/en-words.txt",
    false},
 
-  {SUBSET_FONT_BASE_PATH "SourceSerifVariable-Roman.ttf",
+  {"Latin",
+   SUBSET_FONT_BASE_PATH "SourceSerifVariable-Roman.ttf",
    "perf/texts/en-thelittleprince.txt",
    true},
+
+  {"Khmer",
+   SUBSET_FONT_BASE_PATH "Khmer.ttf",
+   "perf/texts/km-words.txt",
+   false},
+
+  {"Myanmar",
+   SUBSET_FONT_BASE_PATH "NotoSerifMyanmar-Regular.otf",
+   "perf/texts/my-words.txt",
+   false},
+
+  {"Thai",
+   "test/fuzzing/fonts/kanit.ttf",
+   "perf/texts/th-words.txt",
+   false},
+
+  {"Tamil (AAT)",
+   "test/shape/data/in-house/fonts/e6185e88b04432fbf373594d5971686bb7dd698d.ttf",
+   "perf/texts/ta-words.txt",
+   false},
+
+  {"Hangul",
+   "perf/fonts/NotoSansKR-Regular.otf",
+   "perf/texts/ko-words.txt",
+   false},
+
+  {"CJK",
+   "perf/fonts/NotoSansSC-Regular.otf",
+   "perf/texts/zh-words.txt",
+   false},
+
+  {"Emoji",
+   "perf/fonts/NotoColorEmoji.ttf",
+   "perf/texts/emoji.txt",
+   false},
 };
 
 static test_input_t *tests = default_tests;
@@ -97,7 +148,10 @@ static void BM_Shape (benchmark::State &state,
   const char *orig_text = hb_blob_get_data (text_blob, &orig_text_length);
 
   hb_buffer_t *buf = hb_buffer_create ();
-  for (auto _ : state)
+
+  unsigned num_shapes = 0;
+  unsigned num_glyphs = 0;
+  auto shape_text = [&] ()
   {
     unsigned text_length = orig_text_length;
     const char *text = orig_text;
@@ -110,11 +164,43 @@ static void BM_Shape (benchmark::State &state,
       hb_buffer_guess_segment_properties (buf);
       hb_shape (font, buf, nullptr, 0);
 
+      num_shapes++;
+      num_glyphs += hb_buffer_get_length (buf);
+
       unsigned skip = end - text + 1;
       text_length -= skip;
       text += skip;
     }
-  }
+  };
+
+  /* Warm up the font and buffer, and count what one pass produces. */
+  shape_text ();
+  unsigned shapes_per_pass = num_shapes;
+  unsigned glyphs_per_pass = num_glyphs;
+
+#ifdef HAVE_ALLOC_COUNTING
+  unsigned long allocs_before = num_allocs.load (std::memory_order_relaxed);
+#endif
+
+  for (auto _ : state)
+    shape_text ();
+
+#ifdef HAVE_ALLOC_COUNTING
+  unsigned long allocs = num_allocs.load (std::memory_order_relaxed) - allocs_before;
+#endif
+
+  double total_glyphs = (double) glyphs_per_pass * state.iterations ();
+  state.counters["glyphs/s"] = benchmark::Counter (total_glyphs,
+						   benchmark::Counter::kIsRate);
+  state.counters["time/glyph"] = benchmark::Counter (total_glyphs,
+						     benchmark::Counter::kIsRate |
+						     benchmark::Counter::kInvert);
+#ifdef HAVE_ALLOC_COUNTING
+  double total_shapes = (double) shapes_per_pass * state.iterations ();
+  state.counters["allocs/shape"] = total_shapes ? allocs / total_shapes : 0.;
+#endif
+  state.SetLabel (input.script);
+
   hb_buffer_destroy (buf);
 
   hb_blob_destroy (text_blob);
@@ -142,6 +228,14 @@ static void test_backend (backend_t backend,
    ->Unit(benchmark::kMillisecond);
 }
 
+static bool file_exists (const char *path)
+{
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (path);
+  bool ret = blob;
+  hb_blob_destroy (blob);
+  return ret;
+}
+
 int main(int argc, char** argv)
 {
   benchmark::Initialize(&argc, argv);
@@ -152,6 +246,7 @@ int main(int argc, char** argv)
     tests = (test_input_t *) calloc (num_tests, sizeof (test_input_t));
     for (unsigned i = 0; i < num_tests; i++)
     {
+      tests[i].script = "";
       tests[i].is_variable = true;
       tests[i].font_path = argv[1 + i * 2];
       tests[i].text_path = argv[2 + i * 2];
@@ -161,6 +256,16 @@ int main(int argc, char** argv)
   for (unsigned i = 0; i < num_tests; i++)
   {
     auto& test_input = tests[i];
+    if (tests == default_tests &&
+	(!file_exists (test_input.font_path) ||
+	 !file_exists (test_input.text_path)))
+    {
+      fprintf (stderr, "Skipping %s benchmark: %s not found.\n",
+	       test_input.script,
+	       file_exists (test_input.font_path) ? test_input.text_path : test_input.font_path);
+      continue;
+    }
+
     for (int variable = 0; variable < int (test_input.is_variable) + 1; variable++)
     {
       bool is_var = (bool) variable;
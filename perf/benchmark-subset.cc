@@ -1,6 +1,8 @@
 #include "benchmark/benchmark.h"
 #include <cassert>
 #include <cstring>
+#include <cstdio>
+#include <vector>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -8,6 +10,8 @@
 
 #include "hb-subset.h"
 
+#include "benchmark-alloc.hh"
+
 
 enum operation_t
 {
@@ -58,28 +62,33 @@ static inline unsigned int ARRAY_LEN (const Type (&)[n]) { return n; }
 
 #define SUBSET_FONT_BASE_PATH "test/subset/data/fonts/"
 
+/* Fonts under perf/fonts/ are not in the tree (they are too large to
+ * check in) and are skipped when missing; drop them in to cover subsets
+ * of up to 20k glyphs. */
+
 struct test_input_t
 {
+  const char *format;
   const char *font_path;
   unsigned max_subset_size;
   const axis_location_t *instance_opts;
   unsigned num_instance_opts;
 } default_tests[] =
 {
-  {SUBSET_FONT_BASE_PATH "Roboto-Regular.ttf", 1000, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "Amiri-Regular.ttf", 4096, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "NotoNastaliqUrdu-Regular.ttf", 1400, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "NotoSansDevanagari-Regular.ttf", 1000, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "Mplus1p-Regular.ttf", 10000, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", 10000, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "SourceSansPro-Regular.otf", 2000, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "AdobeVFPrototype.otf", 300, nullptr, 0},
-  {SUBSET_FONT_BASE_PATH "MPLUS1-Variable.ttf", 6000, _mplus_instance_opts, ARRAY_LEN (_mplus_instance_opts)},
-  {SUBSET_FONT_BASE_PATH "RobotoFlex-Variable.ttf", 900, _roboto_flex_instance_opts, ARRAY_LEN (_roboto_flex_instance_opts)},
-  {SUBSET_FONT_BASE_PATH "Fraunces.ttf", 900, _fraunces_partial_instance_opts, ARRAY_LEN (_fraunces_partial_instance_opts)},
-#if 0
-  {"perf/fonts/NotoSansCJKsc-VF.ttf", 100000},
-#endif
+  {"glyf", SUBSET_FONT_BASE_PATH "Roboto-Regular.ttf", 1000, nullptr, 0},
+  {"glyf", SUBSET_FONT_BASE_PATH "Amiri-Regular.ttf", 4096, nullptr, 0},
+  {"glyf", SUBSET_FONT_BASE_PATH "NotoNastaliqUrdu-Regular.ttf", 1400, nullptr, 0},
+  {"glyf", SUBSET_FONT_BASE_PATH "NotoSansDevanagari-Regular.ttf", 1000, nullptr, 0},
+  {"glyf", SUBSET_FONT_BASE_PATH "Mplus1p-Regular.ttf", 10000, nullptr, 0},
+  {"CFF", SUBSET_FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", 10000, nullptr, 0},
+  {"CFF", SUBSET_FONT_BASE_PATH "SourceSansPro-Regular.otf", 2000, nullptr, 0},
+  {"CFF2", SUBSET_FONT_BASE_PATH "AdobeVFPrototype.otf", 300, nullptr, 0},
+  {"glyf-var", SUBSET_FONT_BASE_PATH "MPLUS1-Variable.ttf", 6000, _mplus_instance_opts, ARRAY_LEN (_mplus_instance_opts)},
+  {"glyf-var", SUBSET_FONT_BASE_PATH "RobotoFlex-Variable.ttf", 900, _roboto_flex_instance_opts, ARRAY_LEN (_roboto_flex_instance_opts)},
+  {"glyf-var", SUBSET_FONT_BASE_PATH "Fraunces.ttf", 900, _fraunces_partial_instance_opts, ARRAY_LEN (_fraunces_partial_instance_opts)},
+  {"COLRv1", SUBSET_FONT_BASE_PATH "Foldit.ttf", 17, nullptr, 0},
+  {"CFF2", "perf/fonts/NotoSansCJKsc-VF.otf", 20000, _mplus_instance_opts, ARRAY_LEN (_mplus_instance_opts)},
+  {"COLRv1", "perf/fonts/Noto-COLRv1.ttf", 4000, nullptr, 0},
 };
 
 static test_input_t *tests = default_tests;
@@ -133,24 +142,16 @@ free_cached_face (void)
   cached_face = nullptr;
 }
 
-
-/* benchmark for subsetting a font */
-static void BM_subset (benchmark::State &state,
-                       operation_t operation,
-                       const test_input_t &test_input,
-                       bool retain_gids)
+static hb_face_t *
+get_face (const test_input_t &test_input)
 {
-  unsigned subset_size = state.range(0);
-
-  hb_face_t *face = nullptr;
-
   static const char *cached_font_path;
 
   if (!cached_font_path || strcmp (cached_font_path, test_input.font_path))
   {
     hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
     assert (blob);
-    face = hb_face_create (blob, 0);
+    hb_face_t *face = hb_face_create (blob, 0);
     hb_blob_destroy (blob);
 
     face = preprocess_face (face);
@@ -158,17 +159,24 @@ static void BM_subset (benchmark::State &state,
     if (cached_face)
       hb_face_destroy (cached_face);
 
-    cached_face = hb_face_reference (face);
+    cached_face = face;
     cached_font_path = test_input.font_path;
   }
-  else
-    face = hb_face_reference (cached_face);
 
+  return hb_face_reference (cached_face);
+}
+
+static hb_subset_input_t *
+create_input (hb_face_t *face,
+              operation_t operation,
+              const test_input_t &test_input,
+              unsigned subset_size,
+              unsigned flags)
+{
   hb_subset_input_t* input = hb_subset_input_create_or_fail ();
   assert (input);
 
-  if (retain_gids)
-    hb_subset_input_set_flags (input, HB_SUBSET_FLAGS_RETAIN_GIDS);
+  hb_subset_input_set_flags (input, flags);
 
   switch (operation)
   {
@@ -205,6 +213,36 @@ static void BM_subset (benchmark::State &state,
     break;
   }
 
+  return input;
+}
+
+static void
+report_memory (benchmark::State &state,
+               hb_face_t *face,
+               hb_subset_input_t *input)
+{
+#ifdef HAVE_HEAP_TRACKING
+  long peak_heap = measure_peak_heap ([&] () {
+    hb_face_t* subset = hb_subset_or_fail (face, input);
+    hb_face_destroy (subset);
+  });
+  state.counters["peak_heap"] = benchmark::Counter (peak_heap,
+                                                    benchmark::Counter::kDefaults,
+                                                    benchmark::Counter::OneK::kIs1024);
+#endif
+}
+
+/* benchmark for subsetting a font */
+static void BM_subset (benchmark::State &state,
+                       operation_t operation,
+                       const test_input_t &test_input,
+                       unsigned flags)
+{
+  unsigned subset_size = state.range(0);
+
+  hb_face_t *face = get_face (test_input);
+  hb_subset_input_t* input = create_input (face, operation, test_input, subset_size, flags);
+
   for (auto _ : state)
   {
     hb_face_t* subset = hb_subset_or_fail (face, input);
@@ -212,13 +250,81 @@ static void BM_subset (benchmark::State &state,
     hb_face_destroy (subset);
   }
 
+  report_memory (state, face, input);
+  state.SetLabel (test_input.format);
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
+/* Breaks the time of subsetting a font down by table.  The time spent
+ * in each table stage of a full subset, including repacking, is
+ * reported in microseconds as a counter named after the table.  Work
+ * the plan does on behalf of a table, such as the layout closure for
+ * GSUB, is not included. */
+struct table_times_t
+{
+  std::vector<hb_tag_t> tags;
+  std::vector<uint64_t> ns;
+};
+
+static void
+table_stage_func (const hb_subset_stage_info_t *info,
+                  void *user_data)
+{
+  if (info->stage != HB_SUBSET_STAGE_TABLE || !info->end_ns)
+    return;
+
+  table_times_t *times = (table_times_t *) user_data;
+  for (unsigned i = 0; i < times->tags.size (); i++)
+    if (times->tags[i] == info->table_tag)
+    {
+      times->ns[i] += info->end_ns - info->start_ns;
+      return;
+    }
+}
+
+static void BM_subset_tables (benchmark::State &state,
+                              const test_input_t &test_input)
+{
+  unsigned subset_size = state.range(0);
+
+  hb_face_t *face = get_face (test_input);
+  hb_subset_input_t* input = create_input (face, subset_unicodes, test_input, subset_size, 0);
+
+  table_times_t times;
+  times.tags.resize (hb_face_get_table_tags (face, 0, nullptr, nullptr));
+  unsigned num_tables = times.tags.size ();
+  hb_face_get_table_tags (face, 0, &num_tables, times.tags.data ());
+  times.ns.resize (num_tables);
+
+  hb_subset_input_set_stage_func (input, table_stage_func, &times);
+
+  for (auto _ : state)
+  {
+    hb_face_t* subset = hb_subset_or_fail (face, input);
+    assert (subset);
+    hb_face_destroy (subset);
+  }
+
+  for (unsigned i = 0; i < num_tables; i++)
+  {
+    if (!times.ns[i])
+      continue;
+    char name[5];
+    hb_tag_to_string (times.tags[i], name);
+    name[4] = '\0';
+    state.counters[name] = benchmark::Counter (times.ns[i] * 1e-3 / state.iterations ());
+  }
+  state.SetLabel (test_input.format);
+
   hb_subset_input_destroy (input);
   hb_face_destroy (face);
 }
 
 static void test_subset (operation_t op,
                          const char *op_name,
-                         bool retain_gids,
+                         unsigned flags,
                          benchmark::TimeUnit time_unit,
                          const test_input_t &test_input)
 {
@@ -230,10 +336,12 @@ static void test_subset (operation_t op,
   strcat (name, "/");
   const char *p = strrchr (test_input.font_path, '/');
   strcat (name, p ? p + 1 : test_input.font_path);
-  if (retain_gids)
+  if (flags & HB_SUBSET_FLAGS_RETAIN_GIDS)
     strcat (name, "/retaingids");
+  if (flags & HB_SUBSET_FLAGS_NO_LAYOUT_CLOSURE)
+    strcat (name, "/nolayoutclosure");
 
-  benchmark::RegisterBenchmark (name, BM_subset, op, test_input, retain_gids)
+  benchmark::RegisterBenchmark (name, BM_subset, op, test_input, flags)
       ->Range(10, test_input.max_subset_size)
       ->Unit(time_unit);
 }
@@ -247,11 +355,43 @@ static void test_operation (operation_t op,
   for (unsigned i = 0; i < num_tests; i++)
   {
     auto& test_input = tests[i];
-    test_subset (op, op_name, true, time_unit, test_input);
-    test_subset (op, op_name, false, time_unit, test_input);
+    if (!test_input.font_path)
+      continue;
+
+    for (unsigned flags : {HB_SUBSET_FLAGS_RETAIN_GIDS,
+                           HB_SUBSET_FLAGS_DEFAULT,
+                           HB_SUBSET_FLAGS_NO_LAYOUT_CLOSURE})
+      test_subset (op, op_name, flags, time_unit, test_input);
   }
 }
 
+static void test_tables (const test_input_t *tests,
+                         unsigned num_tests)
+{
+  for (unsigned i = 0; i < num_tests; i++)
+  {
+    auto& test_input = tests[i];
+    if (!test_input.font_path)
+      continue;
+
+    char name[1024] = "BM_subset_tables/";
+    const char *p = strrchr (test_input.font_path, '/');
+    strcat (name, p ? p + 1 : test_input.font_path);
+
+    benchmark::RegisterBenchmark (name, BM_subset_tables, test_input)
+        ->Arg(test_input.max_subset_size < 1000 ? test_input.max_subset_size : 1000)
+        ->Unit(benchmark::kMillisecond);
+  }
+}
+
+static bool file_exists (const char *path)
+{
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (path);
+  bool ret = blob;
+  hb_blob_destroy (blob);
+  return ret;
+}
+
 int main(int argc, char** argv)
 {
   benchmark::Initialize(&argc, argv);
@@ -266,10 +406,20 @@ int main(int argc, char** argv)
     tests = (test_input_t *) calloc (num_tests, sizeof (test_input_t));
     for (unsigned i = 0; i < num_tests; i++)
     {
+      tests[i].format = "";
       tests[i].font_path = argv[1 + i * 2];
       tests[i].max_subset_size = atoi (argv[2 + i * 2]);
     }
   }
+  else
+  {
+    for (unsigned i = 0; i < num_tests; i++)
+      if (!file_exists (tests[i].font_path))
+      {
+        fprintf (stderr, "Skipping %s: not found.\n", tests[i].font_path);
+        tests[i].font_path = nullptr;
+      }
+  }
 
 #define TEST_OPERATION(op, time_unit) test_operation (op, #op, tests, num_tests, time_unit)
 
@@ -279,6 +429,8 @@ int main(int argc, char** argv)
 
 #undef TEST_OPERATION
 
+  test_tables (tests, num_tests);
+
   benchmark::RunSpecifiedBenchmarks();
   benchmark::Shutdown();
 
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+
+"""Compares two Google Benchmark JSON outputs.
+
+usage: compare-benchmarks.py [--threshold PERCENT] [--metric real_time|cpu_time]
+                             BASELINE.json CONTENDER.json
+
+Produce the inputs with, e.g.:
+
+  ./build/perf/benchmark-shape --benchmark_repetitions=5 \\
+      --benchmark_out=before.json --benchmark_out_format=json
+
+Benchmarks are matched by name.  When the runs have repetitions, their
+median aggregate is compared; otherwise the single iteration run is.
+Prints the change in time for every benchmark in both files, along with
+the time per glyph and allocations per shape where those are reported.
+
+Exits with status 1 if any benchmark got slower by more than the
+threshold (default 5%), so it can be used to gate changes locally.
+"""
+
+import sys, json, argparse
+
+def load (path):
+	with open (path, encoding='utf-8') as f:
+		data = json.load (f)
+
+	runs = {}
+	medians = {}
+	for b in data['benchmarks']:
+		if b.get ('error_occurred'):
+			continue
+		name = b.get ('run_name', b['name'])
+		if b.get ('run_type') == 'aggregate':
+			if b.get ('aggregate_name') == 'median':
+				medians[name] = b
+		elif name not in runs:
+			runs[name] = b
+	runs.update (medians)
+	return runs
+
+def change (old, new):
+	if not old:
+		return float ('nan')
+	return (new - old) / old * 100.
+
+parser = argparse.ArgumentParser (description='Compare two benchmark JSON files.')
+parser.add_argument ('--threshold', type=float, default=5.,
+		     help='percent slowdown considered a regression (default: 5)')
+parser.add_argument ('--metric', choices=['real_time', 'cpu_time'], default='cpu_time',
+		     help='time measurement to compare (default: cpu_time)')
+parser.add_argument ('baseline')
+parser.add_argument ('contender')
+args = parser.parse_args ()
+
+baseline = load (args.baseline)
+contender = load (args.contender)
+
+names = [name for name in contender if name in baseline]
+if not names:
+	print ('compare-benchmarks.py: no benchmarks in common', file=sys.stderr)
+	sys.exit (2)
+
+width = max (len (name) for name in names)
+print ('%-*s  %12s  %12s  %8s  %10s  %10s' % (width, 'Benchmark', 'Old', 'New', 'Time',
+					      'ns/glyph', 'allocs'))
+
+regressions = []
+for name in names:
+	old, new = baseline[name], contender[name]
+	old_time, new_time = old[args.metric], new[args.metric]
+	time_change = change (old_time, new_time)
+
+	ns_per_glyph = ''
+	if 'time/glyph' in new:
+		ns_per_glyph = '%.1f' % (new['time/glyph'] * 1e9)
+	allocs = ''
+	if 'allocs/shape' in new:
+		allocs = '%.2f' % new['allocs/shape']
+		if 'allocs/shape' in old and new['allocs/shape'] != old['allocs/shape']:
+			allocs += ' (%+.2f)' % (new['allocs/shape'] - old['allocs/shape'])
+
+	print ('%-*s  %10.3f%-2s  %10.3f%-2s  %+7.1f%%  %10s  %10s' % (width, name,
+									old_time, old['time_unit'],
+									new_time, new['time_unit'],
+									time_change,
+									ns_per_glyph, allocs))
+
+	if time_change > args.threshold:
+		regressions.append ((name, time_change))
+
+missing = [name for name in baseline if name not in contender]
+for name in missing:
+	print ('%s: missing from %s' % (name, args.contender), file=sys.stderr)
+
+if regressions:
+	print ()
+	print ('%d benchmark(s) slower by more than %g%%:' % (len (regressions), args.threshold))
+	for name, time_change in regressions:
+		print ('  %s: %+.1f%%' % (name, time_change))
+	sys.exit (1)
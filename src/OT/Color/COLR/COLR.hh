@@ -2508,11 +2508,16 @@ struct COLR
     if (version != 1)
       return false;
 
-    ItemVarStoreInstancer instancer (&(this+varStore),
+    const ItemVariationStore &var_store = this+varStore;
+    auto *cache = var_store.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_COLR);
+    ItemVarStoreInstancer instancer (&var_store,
 				 &(this+varIdxMap),
-				 hb_array (font->coords, font->num_coords));
+				 hb_array (font->coords, font->num_coords),
+				 cache);
 
-    if (get_clip (glyph, extents, instancer))
+    bool has_clip = get_clip (glyph, extents, instancer);
+    ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_COLR, cache);
+    if (has_clip)
     {
       font->scale_glyph_extents (extents);
       return true;
@@ -2570,9 +2575,20 @@ struct COLR
   bool
   paint_glyph (hb_font_t *font, hb_codepoint_t glyph, hb_paint_funcs_t *funcs, void *data, unsigned int palette_index, hb_color_t foreground, bool clip = true) const
   {
-    ItemVarStoreInstancer instancer (&(this+varStore),
+    const ItemVariationStore &var_store = this+varStore;
+    auto *cache = var_store.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_COLR);
+    ItemVarStoreInstancer instancer (&var_store,
 	                         &(this+varIdxMap),
-	                         hb_array (font->coords, font->num_coords));
+	                         hb_array (font->coords, font->num_coords),
+	                         cache);
+    bool ret = paint_glyph (font, glyph, funcs, data, palette_index, foreground, clip, instancer);
+    ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_COLR, cache);
+    return ret;
+  }
+
+  bool
+  paint_glyph (hb_font_t *font, hb_codepoint_t glyph, hb_paint_funcs_t *funcs, void *data, unsigned int palette_index, hb_color_t foreground, bool clip, ItemVarStoreInstancer &instancer) const
+  {
     hb_paint_context_t c (this, funcs, data, font, palette_index, foreground, instancer);
     c.current_glyphs.add (glyph);
 
@@ -2606,7 +2622,7 @@ struct COLR
 	    paint_glyph (font, glyph,
 			 extents_funcs, &extents_data,
 			 palette_index, foreground,
-			 false);
+			 false, instancer);
 
 	    hb_extents_t extents = extents_data.get_extents ();
 	    is_bounded = extents_data.is_bounded ();
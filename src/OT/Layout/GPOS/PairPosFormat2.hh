@@ -123,11 +123,18 @@ struct PairPosFormat2_4 : ValueBase
 
   const Coverage &get_coverage () const { return this+coverage; }
 
+  unsigned get_class_defs (const ClassDef **class_defs) const
+  {
+    class_defs[0] = &(this+classDef1);
+    class_defs[1] = &(this+classDef2);
+    return 2;
+  }
+
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
     hb_buffer_t *buffer = c->buffer;
-    unsigned int index = (this+coverage).get_coverage  (buffer->cur().codepoint);
+    unsigned int index = c->get_coverage (this+coverage, buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
     hb_ot_apply_context_t::skipping_iterator_t &skippy_iter = c->iter_input;
@@ -139,8 +146,8 @@ struct PairPosFormat2_4 : ValueBase
       return_trace (false);
     }
 
-    unsigned int klass1 = (this+classDef1).get_class (buffer->cur().codepoint);
-    unsigned int klass2 = (this+classDef2).get_class (buffer->info[skippy_iter.idx].codepoint);
+    unsigned int klass1 = c->get_class (this+classDef1, buffer->cur().codepoint);
+    unsigned int klass2 = c->get_class (this+classDef2, buffer->info[skippy_iter.idx].codepoint);
     if (unlikely (klass1 >= class1Count || klass2 >= class2Count))
     {
       buffer->unsafe_to_concat (buffer->idx, skippy_iter.idx + 1);
@@ -451,6 +451,8 @@ struct graph_t
         distance_invalid (true),
         positions_invalid (true),
         successful (true),
+        num_sorted_vertices (0),
+        sorted_prefix (0),
         buffers ()
   {
     num_roots_for_space_.push (1);
@@ -557,6 +559,7 @@ struct graph_t
     link->objidx = child_id;
     link->position = (char*) offset - (char*) v.obj.head;
     vertices_[child_id].add_parent (parent_id);
+    sorted_prefix = 0;
   }
 
   /*
@@ -575,8 +578,38 @@ struct graph_t
    * distance to each node.
    */
   void sort_shortest_distance ()
+  {
+    sort_shortest_distance (0);
+  }
+
+  /*
+   * Generates the same ordering as sort_shortest_distance (), but if the graph
+   * has only been changed by duplicating shared nodes and raising priorities
+   * since the last sort, the start of the previous ordering that those changes
+   * can't have affected is reused and only the remainder is re-sorted.
+   * Any other change falls back to a full sort.
+   */
+  void sort_shortest_distance_incremental ()
+  {
+    if (distance_invalid)
+      sorted_prefix = 0;
+
+    if (sorted_prefix && sorted_prefix >= vertices_.length)
+      // Nothing has changed since the last sort.
+      return;
+
+    sort_shortest_distance (sorted_prefix);
+  }
+
+ private:
+  /*
+   * Sorts the graph, taking the first prefix vertices of the ordering
+   * as-is from the previous sort.
+   */
+  void sort_shortest_distance (unsigned prefix)
   {
     positions_invalid = true;
+    sorted_prefix = 0;
 
     if (vertices_.length <= 1) {
       // Graph of 1 or less doesn't need sorting.
@@ -596,9 +629,26 @@ struct graph_t
     if (unlikely (!check_success (removed_edges.resize (vertices_.length)))) return;
     update_parents ();
 
-    queue.insert (root ().modified_distance (0), root_idx ());
-    int new_id = root_idx ();
     unsigned order = 1;
+    if (prefix && !replay_sorted_prefix (prefix, queue, removed_edges, order))
+    {
+      // The previous ordering doesn't match the graph, start from scratch.
+      prefix = 0;
+      order = 1;
+      queue.reset ();
+      hb_memset (removed_edges.arrayZ, 0, removed_edges.get_size ());
+    }
+
+    int new_id = root_idx ();
+    for (unsigned step = 0; step < prefix; step++)
+    {
+      unsigned next_id = sorted_vertex_at (step);
+      sorted_graph[new_id] = std::move (vertices_[next_id]);
+      id_map[next_id] = new_id--;
+    }
+
+    if (!prefix)
+      queue.insert (root ().modified_distance (0), root_idx ());
     while (!queue.in_error () && !queue.is_empty ())
     {
       unsigned next_id = queue.pop_minimum().second;
@@ -635,9 +685,81 @@ struct graph_t
     vertices_ = std::move (sorted_graph);
 
     if (!check_success (new_id == -1))
+    {
       print_orphaned_nodes ();
+      return;
+    }
+
+    num_sorted_vertices = sorted_prefix = vertices_.length;
+  }
+
+  /*
+   * Returns the index of the vertex that was placed at step (counting from the root)
+   * by the previous sort.
+   */
+  unsigned sorted_vertex_at (unsigned step) const
+  {
+    return step ? num_sorted_vertices - 1 - step : root_idx ();
   }
 
+  /*
+   * Runs the first prefix steps of the previous sort again without using the
+   * queue: counts the edges removed by placing those vertices and queues up
+   * the vertices that became ready but are placed later on. order is advanced
+   * just as a full sort would have.
+   *
+   * Returns false if the previous ordering is not a valid start of a
+   * topological sorting of the current graph.
+   */
+  bool replay_sorted_prefix (unsigned prefix,
+                             hb_priority_queue_t<int64_t>& queue,
+                             hb_vector_t<unsigned>& removed_edges,
+                             unsigned& order)
+  {
+    if (prefix > num_sorted_vertices || num_sorted_vertices > vertices_.length)
+      return false;
+
+    for (unsigned step = 0; step < prefix; step++)
+    {
+      unsigned next_id = sorted_vertex_at (step);
+      const vertex_t& next = vertices_[next_id];
+      if (removed_edges[next_id] != next.incoming_edges ())
+        return false;
+
+      for (const auto& link : next.obj.all_links ()) {
+        removed_edges[link.objidx]++;
+        if (vertices_[link.objidx].incoming_edges () - removed_edges[link.objidx])
+          continue;
+
+        unsigned child_order = order++;
+        if (link.objidx < num_sorted_vertices - 1 &&
+            num_sorted_vertices - 1 - link.objidx < prefix)
+          // Placed within the prefix.
+          continue;
+
+        queue.insert (vertices_[link.objidx].modified_distance (child_order),
+                      link.objidx);
+      }
+    }
+
+    return !queue.in_error ();
+  }
+
+  /*
+   * Limits the part of the previous ordering that the next incremental sort
+   * can reuse to the vertices placed up to and including idx.
+   */
+  void invalidate_sort_after (unsigned idx)
+  {
+    unsigned prefix = 0;
+    if (idx == root_idx ())
+      prefix = 1;
+    else if (idx + 1 < num_sorted_vertices)
+      prefix = num_sorted_vertices - idx;
+    sorted_prefix = hb_min (sorted_prefix, prefix);
+  }
+
+ public:
   /*
    * Finds the set of nodes (placed into roots) that should be assigned unique spaces.
    * More specifically this looks for the top most 24 bit or 32 bit links in the graph.
@@ -816,6 +938,7 @@ struct graph_t
   bool isolate_subgraph (hb_set_t& roots)
   {
     update_parents ();
+    bool distances_valid = !distance_invalid;
     hb_map_t subgraph;
 
     // incoming edges to root_idx should be all 32 bit in length so we don't need to de-dup these
@@ -872,6 +995,18 @@ struct graph_t
     remap_obj_indices (index_map, new_subgraph);
     remap_obj_indices (index_map, parents.iter (), true);
 
+    if (distances_valid)
+    {
+      // Only the subgraph and everything below the nodes that were split off
+      // from it can have a different distance now.
+      hb_set_t stale;
+      for (unsigned node_idx : new_subgraph)
+        stale.add (node_idx);
+      for (unsigned node_idx : index_map.keys ())
+        find_subgraph (node_idx, stale);
+      mark_distances_stale (stale);
+    }
+
     // Update roots set with new indices as needed.
     for (auto next : roots)
     {
@@ -1085,6 +1220,9 @@ struct graph_t
     DEBUG_MSG (SUBSET_REPACK, nullptr, "  Duplicating %u => %u",
                parent_idx, child_idx);
 
+    bool distances_valid = !distance_invalid && !stale_distances;
+    invalidate_sort_after_parents (child_idx);
+
     unsigned clone_idx = duplicate (child_idx);
     if (clone_idx == (unsigned) -1) return -1;
     // duplicate shifts the root node idx, so if parent_idx was root update it.
@@ -1099,6 +1237,9 @@ struct graph_t
       reassign_link (l, parent_idx, clone_idx);
     }
 
+    if (distances_valid)
+      update_duplicated_distances (child_idx, clone_idx);
+
     return clone_idx;
   }
 
@@ -1139,6 +1280,9 @@ struct graph_t
 
     DEBUG_MSG (SUBSET_REPACK, nullptr, "  Duplicating %u, ..., %u => %u", first_parent, last_parent, child_idx);
 
+    bool distances_valid = !distance_invalid && !stale_distances;
+    invalidate_sort_after_parents (child_idx);
+
     unsigned clone_idx = duplicate (child_idx);
     if (clone_idx == (unsigned) -1) return false;
 
@@ -1155,6 +1299,9 @@ struct graph_t
       }
     }
 
+    if (distances_valid)
+      update_duplicated_distances (child_idx, clone_idx);
+
     return clone_idx;
   }
 
@@ -1205,6 +1352,10 @@ struct graph_t
     bool made_change = false;
     for (auto& l : parent.all_links_writer ())
       made_change |= vertices_[l.objidx].raise_priority ();
+    if (made_change)
+      // The children can't be placed before their parent so the
+      // ordering up to it stays the same.
+      invalidate_sort_after (parent_idx);
     return made_change;
   }
 
@@ -1308,6 +1459,7 @@ struct graph_t
   {
     num_roots_for_space_.push (0);
     unsigned new_space = num_roots_for_space_.length - 1;
+    bool distances_valid = !distance_invalid;
 
     for (unsigned index : indices) {
       auto& node = vertices_[index];
@@ -1317,6 +1469,16 @@ struct graph_t
       distance_invalid = true;
       positions_invalid = true;
     }
+
+    if (distances_valid && indices)
+    {
+      // The space only factors into the distances of the moved nodes and
+      // everything below them.
+      hb_set_t stale;
+      for (unsigned index : indices)
+        find_subgraph (index, stale);
+      mark_distances_stale (stale);
+    }
   }
 
   unsigned space_for (unsigned index, unsigned* root = nullptr) const
@@ -1435,7 +1597,12 @@ struct graph_t
    */
   void update_distances ()
   {
-    if (!distance_invalid) return;
+    if (!distance_invalid)
+    {
+      update_stale_distances ();
+      return;
+    }
+    stale_distances.clear ();
 
     // Uses Dijkstra's algorithm to find all of the shortest distances.
     // https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
@@ -1471,11 +1638,7 @@ struct graph_t
       {
         if (visited[link.objidx]) continue;
 
-        const auto& child = vertices_.arrayZ[link.objidx].obj;
-        unsigned link_width = link.width ? link.width : 4; // treat virtual offsets as 32 bits wide
-        int64_t child_weight = (child.tail - child.head) +
-                               ((int64_t) 1 << (link_width * 8)) * (vertices_.arrayZ[link.objidx].space + 1);
-        int64_t child_distance = next_distance + child_weight;
+        int64_t child_distance = next_distance + link_weight (link);
 
         if (child_distance < vertices_.arrayZ[link.objidx].distance)
         {
@@ -1496,6 +1659,113 @@ struct graph_t
   }
 
  private:
+  /*
+   * Returns the weight that following link adds to the distance of the child.
+   */
+  int64_t link_weight (const hb_serialize_context_t::object_t::link_t& link) const
+  {
+    const auto& child = vertices_.arrayZ[link.objidx];
+    unsigned link_width = link.width ? link.width : 4; // treat virtual offsets as 32 bits wide
+    return (child.obj.tail - child.obj.head) +
+           ((int64_t) 1 << (link_width * 8)) * (child.space + 1);
+  }
+
+  /*
+   * Recomputes the distances of a duplicated node and its clone, given that the
+   * distances were valid before the duplication.
+   *
+   * Between them the two nodes have the same incoming links the original had, so
+   * the smaller of their distances is the original distance. The clone has the
+   * same outgoing links, so the distance of every other node is unchanged.
+   */
+  void update_duplicated_distances (unsigned node_idx, unsigned clone_idx)
+  {
+    unsigned nodes[] = {node_idx, clone_idx};
+    for (unsigned idx : nodes)
+    {
+      int64_t distance = hb_int_max (int64_t);
+      for (unsigned p : vertices_[idx].parents_iter ())
+        for (const auto& link : vertices_[p].obj.all_links ())
+          if (link.objidx == idx)
+            distance = hb_min (distance, vertices_[p].distance + link_weight (link));
+      vertices_[idx].distance = distance;
+    }
+    distance_invalid = false;
+  }
+
+  /*
+   * Records that the distances of nodes may have changed while the distances
+   * of all other nodes are still valid. nodes must include everything below
+   * each of its members.
+   */
+  void mark_distances_stale (const hb_set_t& nodes)
+  {
+    for (unsigned idx : nodes)
+      for (unsigned p : vertices_[idx].parents_iter ())
+        // Parents in nodes can't be placed before their own parents.
+        if (!nodes.has (p))
+          invalidate_sort_after (p);
+
+    stale_distances.union_ (nodes);
+    distance_invalid = nodes.in_error () || stale_distances.in_error ();
+  }
+
+  /*
+   * Recomputes the distances of the nodes in stale_distances using the
+   * still valid distances of the other nodes as a starting point.
+   */
+  void update_stale_distances ()
+  {
+    if (!stale_distances) return;
+
+    hb_priority_queue_t<int64_t> queue;
+    for (unsigned idx : stale_distances)
+    {
+      int64_t distance = hb_int_max (int64_t);
+      for (unsigned p : vertices_[idx].parents_iter ())
+      {
+        if (stale_distances.has (p)) continue;
+        for (const auto& link : vertices_[p].obj.all_links ())
+          if (link.objidx == idx)
+            distance = hb_min (distance, vertices_[p].distance + link_weight (link));
+      }
+
+      vertices_[idx].distance = distance;
+      if (distance != hb_int_max (int64_t))
+        queue.insert (distance, idx);
+    }
+
+    while (!queue.in_error () && !queue.is_empty ())
+    {
+      auto next = queue.pop_minimum ();
+      const auto& v = vertices_[next.second];
+      if (next.first != v.distance) continue; // Already reached with a shorter distance.
+
+      for (const auto& link : v.obj.all_links ())
+      {
+        int64_t child_distance = v.distance + link_weight (link);
+        if (child_distance < vertices_.arrayZ[link.objidx].distance)
+        {
+          vertices_.arrayZ[link.objidx].distance = child_distance;
+          queue.insert (child_distance, link.objidx);
+        }
+      }
+    }
+
+    check_success (!queue.in_error ());
+    stale_distances.clear ();
+  }
+
+  /*
+   * Limits the part of the previous ordering that the next incremental sort
+   * can reuse to the vertices placed before node_idx can become ready.
+   */
+  void invalidate_sort_after_parents (unsigned node_idx)
+  {
+    for (unsigned p : vertices_[node_idx].parents_iter ())
+      invalidate_sort_after (p);
+  }
+
   /*
    * Updates a link in the graph to point to a different object. Corrects the
    * parents vector on the previous and new child nodes.
@@ -1592,6 +1862,9 @@ struct graph_t
   bool distance_invalid;
   bool positions_invalid;
   bool successful;
+  unsigned num_sorted_vertices; // Number of vertices when the graph was last sorted.
+  unsigned sorted_prefix; // Number of vertices at the start of the last sort that are still valid.
+  hb_set_t stale_distances; // Nodes whose distance needs to be recomputed, see mark_distances_stale ().
   hb_vector_t<unsigned> num_roots_for_space_;
   hb_vector_t<char*> buffers;
 };
@@ -51,6 +51,7 @@
 #include "hb-paint-extents.cc"
 #include "hb-paint.cc"
 #include "hb-set.cc"
+#include "hb-shape-cache.cc"
 #include "hb-shape-plan.cc"
 #include "hb-shape.cc"
 #include "hb-shaper.cc"
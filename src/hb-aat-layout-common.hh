@@ -42,6 +42,7 @@ using namespace OT;
 #define HB_AAT_BUFFER_DIGEST_THRESHOLD 32
 
 struct ankr;
+struct hb_aat_class_cache_t;
 
 struct hb_aat_apply_context_t :
        hb_dispatch_context_t<hb_aat_apply_context_t, bool, HB_DEBUG_APPLY>
@@ -63,6 +64,7 @@ struct hb_aat_apply_context_t :
   const hb_sorted_vector_t<hb_aat_map_t::range_flags_t> *range_flags = nullptr;
   hb_set_digest_t buffer_digest = hb_set_digest_t::full ();
   hb_set_digest_t machine_glyph_set = hb_set_digest_t::full ();
+  hb_atomic_ptr_t<hb_aat_class_cache_t> *machine_class_cache = nullptr;
   hb_set_digest_t left_set = hb_set_digest_t::full ();
   hb_set_digest_t right_set = hb_set_digest_t::full ();
   hb_mask_t subtable_flags = 0;
@@ -614,6 +616,64 @@ enum Class
   CLASS_END_OF_LINE = 3,
 };
 
+/* The classes of a state table's class lookup, flattened into a byte per
+ * glyph over the range of glyphs the lookup covers, so that the driver
+ * doesn't have to search the lookup for every glyph.  Classes past
+ * nClasses are stored as CLASS_OUT_OF_BOUNDS, which is what get_entry()
+ * maps them to anyway.  Glyphs outside the range, or past num_glyphs, are
+ * left to the lookup.  State tables with more than 255 classes get an
+ * empty cache. */
+struct hb_aat_class_cache_t
+{
+  template <typename ClassType>
+  static hb_aat_class_cache_t *create (const ClassType &class_table,
+				       unsigned num_classes,
+				       unsigned num_glyphs)
+  {
+    struct range_t
+    {
+      void add (hb_codepoint_t g) { add_range (g, g); }
+      void add_range (hb_codepoint_t a, hb_codepoint_t b)
+      {
+	b = hb_min (b, last_glyph);
+	if (a > b) return;
+	first = hb_min (first, a);
+	last = hb_max (last, b);
+      }
+      hb_codepoint_t last_glyph;
+      hb_codepoint_t first = HB_CODEPOINT_INVALID;
+      hb_codepoint_t last = 0;
+    } range;
+    range.last_glyph = num_glyphs - 1;
+    if (num_classes <= 255 && num_glyphs)
+      class_table.collect_glyphs (range, num_glyphs);
+    unsigned length = range.first <= range.last ? range.last - range.first + 1 : 0;
+
+    auto *cache = (hb_aat_class_cache_t *) hb_malloc (sizeof (hb_aat_class_cache_t) - HB_VAR_ARRAY + length);
+    if (unlikely (!cache)) return nullptr;
+    cache->first = range.first;
+    cache->length = length;
+    uint8_t *classes = cache->classes;
+    for (unsigned i = 0; i < length; i++)
+    {
+      unsigned klass = class_table.get_class (range.first + i, num_glyphs, CLASS_OUT_OF_BOUNDS);
+      classes[i] = klass < num_classes ? klass : (unsigned) CLASS_OUT_OF_BOUNDS;
+    }
+    return cache;
+  }
+
+  /* Returns the class of glyph_id, or -1 if not cached. */
+  int get (hb_codepoint_t glyph_id) const
+  {
+    unsigned i = glyph_id - first;
+    return i < length ? classes[i] : -1;
+  }
+
+  hb_codepoint_t first;
+  unsigned length;
+  uint8_t classes[HB_VAR_ARRAY];
+};
+
 template <typename Types, typename Extra>
 struct StateTable
 {
@@ -646,6 +706,23 @@ struct StateTable
     return (this+classTable).get_class (glyph_id, num_glyphs, CLASS_OUT_OF_BOUNDS);
   }
 
+  template <typename set_t>
+  unsigned int get_class (hb_codepoint_t glyph_id,
+			  unsigned int num_glyphs,
+			  const set_t &glyphs,
+			  const hb_aat_class_cache_t *cache) const
+  {
+    if (cache)
+    {
+      int klass = cache->get (glyph_id);
+      if (klass >= 0) return klass;
+    }
+    return get_class (glyph_id, num_glyphs, glyphs);
+  }
+
+  hb_aat_class_cache_t *create_class_cache (unsigned num_glyphs) const
+  { return hb_aat_class_cache_t::create (this+classTable, nClasses, num_glyphs); }
+
   const Entry<Extra> *get_entries () const
   { return (this+entryTable).arrayZ; }
 
@@ -937,6 +1014,32 @@ struct StateTableDriver
 	    machine.new_state (entry.newState) == StateTableT::STATE_START_OF_TEXT;
   }
 
+  /* Fetches the class cache of the machine being applied, building it the
+   * first time. */
+  const hb_aat_class_cache_t *get_class_cache (hb_aat_apply_context_t *ac)
+  {
+#ifndef HB_NO_AAT_LAYOUT_CLASS_CACHE
+    if (!ac->machine_class_cache) return nullptr;
+
+    auto &slot = *ac->machine_class_cache;
+  retry:
+    auto *cache = slot.get_acquire ();
+    if (!cache)
+    {
+      cache = machine.create_class_cache (num_glyphs);
+      if (unlikely (!cache)) return nullptr;
+      if (unlikely (!slot.cmpexch (nullptr, cache)))
+      {
+	hb_free (cache);
+	goto retry;
+      }
+    }
+    return cache;
+#else
+    return nullptr;
+#endif
+  }
+
   template <typename context_t>
   void drive (context_t *c, hb_aat_apply_context_t *ac)
   {
@@ -945,6 +1048,8 @@ struct StateTableDriver
     if (!c->in_place)
       buffer->clear_output ();
 
+    const hb_aat_class_cache_t *class_cache = get_class_cache (ac);
+
     int state = StateTableT::STATE_START_OF_TEXT;
     // If there's only one range, we already checked the flag.
     auto *last_range = ac->range_flags && (ac->range_flags->length > 1) ? &(*ac->range_flags)[0] : nullptr;
@@ -977,7 +1082,7 @@ struct StateTableDriver
       }
 
       unsigned int klass = likely (buffer->idx < buffer->len) ?
-			   machine.get_class (buffer->cur().codepoint, num_glyphs, ac->machine_glyph_set) :
+			   machine.get_class (buffer->cur().codepoint, num_glyphs, ac->machine_glyph_set, class_cache) :
 			   (unsigned) CLASS_END_OF_TEXT;
       DEBUG_MSG (APPLY, nullptr, "c%u at %u", klass, buffer->idx);
       const EntryT &entry = machine.get_entry (state, klass);
@@ -557,6 +557,7 @@ struct LigatureSubtable
 
 	    DEBUG_MSG (APPLY, nullptr, "Produced ligature %u", lig);
 	    if (unlikely (!buffer->replace_glyph (lig))) return;
+	    c->buffer_digest.add (lig);
 
 	    unsigned int lig_end = match_positions[(match_length - 1u) % ARRAY_LENGTH (match_positions)] + 1u;
 	    /* Now go and delete all subsequent components. */
@@ -641,6 +642,10 @@ struct NoncontextualSubtable
     const OT::GDEF &gdef (*c->gdef_table);
     bool has_glyph_classes = gdef.has_glyph_classes ();
 
+    /* Nothing to substitute unless the buffer has one of our glyphs. */
+    if (!c->buffer_digest.may_have (c->machine_glyph_set))
+      return_trace (false);
+
     bool ret = false;
     unsigned int num_glyphs = c->face->get_num_glyphs ();
 
@@ -682,6 +687,12 @@ struct NoncontextualSubtable
     return_trace (ret);
   }
 
+  template <typename set_t>
+  void collect_glyphs (set_t &glyphs, unsigned num_glyphs) const
+  {
+    substitute.collect_glyphs (glyphs, num_glyphs);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -837,6 +848,8 @@ struct InsertionSubtable
 	  if (unlikely (!buffer->copy_glyph ())) return;
 	/* TODO We ignore KashidaLike setting. */
 	if (unlikely (!buffer->replace_glyphs (0, count, glyphs))) return;
+	for (unsigned int i = 0; i < count; i++)
+	  c->buffer_digest.add (glyphs[i]);
 	if (buffer->idx < buffer->len && !before)
 	  buffer->skip_glyph ();
 
@@ -936,6 +949,13 @@ struct hb_accelerate_subtables_context_t :
 
     public:
     hb_set_digest_t digest;
+    mutable hb_atomic_ptr_t<AAT::hb_aat_class_cache_t> class_cache; /* Built lazily by the driver. */
+
+    template <typename T>
+    auto init_ (const T &obj_, unsigned num_glyphs, hb_priority<2>) HB_AUTO_RETURN
+    (
+      obj_.collect_glyphs (this->digest, num_glyphs)
+    )
 
     template <typename T>
     auto init_ (const T &obj_, unsigned num_glyphs, hb_priority<1>) HB_AUTO_RETURN
@@ -999,12 +1019,22 @@ struct hb_aat_layout_chain_accelerator_t
     if (unlikely (!thiz))
       return nullptr;
 
+    thiz->count = count;
     hb_accelerate_subtables_context_t c_accelerate_subtables (thiz->subtables, num_glyphs);
     chain.dispatch (&c_accelerate_subtables);
 
     return thiz;
   }
 
+  static void destroy (hb_aat_layout_chain_accelerator_t *thiz)
+  {
+    if (!thiz) return;
+    for (unsigned i = 0; i < thiz->count; i++)
+      hb_free (thiz->subtables[i].class_cache.get_relaxed ());
+    hb_free (thiz);
+  }
+
+  unsigned count;
   hb_accelerate_subtables_context_t::hb_applicable_t subtables[HB_VAR_ARRAY];
 };
 
@@ -1157,6 +1187,7 @@ struct Chain
 	goto skip;
       c->subtable_flags = subtable->subFeatureFlags;
       c->machine_glyph_set = accel ? accel->subtables[i].digest : hb_set_digest_t::full ();
+      c->machine_class_cache = accel ? &accel->subtables[i].class_cache : nullptr;
 
       if (!(subtable->get_coverage() & ChainSubtable<Types>::AllDirections) &&
 	  HB_DIRECTION_IS_VERTICAL (c->buffer->props.direction) !=
@@ -1311,7 +1342,7 @@ struct mortmorx
     ~accelerator_t ()
     {
       for (unsigned int i = 0; i < this->chain_count; i++)
-	hb_free (this->accels[i]);
+	hb_aat_layout_chain_accelerator_t::destroy (this->accels[i]);
       hb_free (this->accels);
       this->table.destroy ();
     }
@@ -1333,7 +1364,7 @@ struct mortmorx
 
 	if (unlikely (!accels[chain_index].cmpexch (nullptr, accel)))
 	{
-	  hb_free (accel);
+	  hb_aat_layout_chain_accelerator_t::destroy (accel);
 	  goto retry;
 	}
       }
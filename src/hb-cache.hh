@@ -96,4 +96,125 @@ struct hb_cache_t
 };
 
 
+/* Set-associative variant of hb_cache_t, sized at runtime.
+ *
+ * The key is split the same way, but its low set_bits select a set of
+ * `ways` items instead of a single one, so that keys colliding on the
+ * cache index no longer evict each other.  New items are inserted at
+ * the front of their set, pushing the oldest one out.  The thread-unsafe
+ * variant also moves an item one step towards the front on every hit,
+ * approximating LRU; the thread-safe one does not, so that lookups of a
+ * cache shared between threads never write to it.
+ *
+ * Every item still packs key and value into a single int, so concurrent
+ * access may lose or duplicate an item, but never returns a wrong value.
+ *
+ * The number of sets is chosen at creation time; use create() and
+ * destroy().  Hits and misses are counted, for get_stats().
+ */
+
+template <unsigned int key_bits=16,
+	  unsigned int value_bits=16,
+	  unsigned int ways=4,
+	  bool thread_safe=true>
+struct hb_set_assoc_cache_t
+{
+  using item_t = typename std::conditional<thread_safe, hb_atomic_int_t, int>::type;
+
+  static_assert ((ways >= 1), "");
+  static_assert ((value_bits < 32), "");
+
+  /* Smallest set_bits for which a stored item never uses all 32 bits,
+   * such that the all-ones empty item can never match a key. */
+  static constexpr unsigned min_set_bits = key_bits + value_bits >= 32 ? key_bits + value_bits - 31 : 0;
+
+  static hb_set_assoc_cache_t *create (unsigned set_bits)
+  {
+    set_bits = hb_clamp (set_bits, (unsigned) min_set_bits, key_bits);
+    unsigned count = ways << set_bits;
+    auto *cache = (hb_set_assoc_cache_t *) hb_malloc (sizeof (hb_set_assoc_cache_t) +
+						       (count - 1) * sizeof (item_t));
+    if (unlikely (!cache))
+      return nullptr;
+    cache->set_bits = set_bits;
+    new (&cache->hits) hb_atomic_int_t ();
+    new (&cache->misses) hb_atomic_int_t ();
+    cache->clear ();
+    return cache;
+  }
+
+  static void destroy (void *p)
+  {
+    auto *cache = (hb_set_assoc_cache_t *) p;
+    if (!cache)
+      return;
+#if HB_DEBUG_CACHE
+    DEBUG_MSG (CACHE, cache, "%u sets of %u ways; %u hits, %u misses",
+	       1u << cache->set_bits, ways,
+	       (unsigned) cache->hits.get_relaxed (),
+	       (unsigned) cache->misses.get_relaxed ());
+#endif
+    hb_free (cache);
+  }
+
+  void clear ()
+  {
+    unsigned count = ways << set_bits;
+    for (unsigned i = 0; i < count; i++)
+      values[i] = -1;
+  }
+
+  bool get (unsigned int key, unsigned int *value) const
+  {
+    if (unlikely (key >> key_bits))
+      return false;
+    item_t *set = values + (key & ((1u<<set_bits)-1)) * ways;
+    unsigned int tag = key >> set_bits;
+    for (unsigned i = 0; i < ways; i++)
+    {
+      unsigned int v = set[i];
+      if ((v >> value_bits) != tag)
+	continue;
+      if (!thread_safe && i)
+      {
+	set[i] = (int) (unsigned int) set[i - 1];
+	set[i - 1] = (int) v;
+      }
+      *value = v & ((1u<<value_bits)-1);
+      hits.inc ();
+      return true;
+    }
+    misses.inc ();
+    return false;
+  }
+
+  bool set (unsigned int key, unsigned int value)
+  {
+    if (unlikely ((key >> key_bits) || (value >> value_bits)))
+      return false; /* Overflows */
+    item_t *set = values + (key & ((1u<<set_bits)-1)) * ways;
+    for (unsigned i = ways - 1; i; i--)
+      set[i] = (int) (unsigned int) set[i - 1];
+    set[0] = (int) (((key>>set_bits)<<value_bits) | value);
+    return true;
+  }
+
+  void get_stats (unsigned *hits_, unsigned *misses_) const
+  {
+    *hits_ = hits.get_relaxed ();
+    *misses_ = misses.get_relaxed ();
+  }
+
+  unsigned get_population () const { return ways << set_bits; }
+
+  private:
+  hb_set_assoc_cache_t () = delete;
+
+  unsigned set_bits;
+  mutable hb_atomic_int_t hits;
+  mutable hb_atomic_int_t misses;
+  mutable item_t values[1];
+};
+
+
 #endif /* HB_CACHE_HH */
@@ -872,23 +872,171 @@ struct path_procs_t
   }
 };
 
+/* A charstring with its subroutine calls inlined and its operands
+ * decoded, as recorded by cs_interpreter_t::interpret () and replayed by
+ * cs_interpreter_t::replay ().
+ *
+ * Operands are stored as 16.16 fixed, which holds every number a
+ * charstring can encode exactly, under the OpCode_fixedcs op.  Hintmask
+ * tokens store the length of their mask, whose bytes are kept in masks.
+ * Since blends are recomputed on replay, a recording is good at any
+ * variation coords, as long as the operands that decide the path taken
+ * (subroutine numbers, blend counts, vsindex) are literals. */
+struct decoded_cs_t
+{
+  struct token_t
+  {
+    int32_t	value;
+    uint16_t	op;
+  };
+
+  void push_number (int32_t value)
+  {
+    tokens.push (token_t {value, (uint16_t) OpCode_fixedcs});
+    last_was_number = true;
+  }
+
+  void push_op (op_code_t op)
+  {
+    tokens.push (token_t {0, (uint16_t) op});
+    last_was_number = false;
+  }
+
+  void push_mask (op_code_t op, hb_ubytes_t mask)
+  {
+    tokens.push (token_t {(int32_t) mask.length, (uint16_t) op});
+    for (unsigned char b : mask)
+      masks.push (b);
+    last_was_number = false;
+  }
+
+  /* The operand on top of the stack was consumed; it must have been
+   * pushed by the token right before. */
+  void check_literal_operand ()
+  {
+    if (!last_was_number)
+      valid = false;
+    last_was_number = false;
+  }
+
+  /* A subroutine call was inlined; its subroutine number goes too. */
+  void pop_call ()
+  {
+    check_literal_operand ();
+    if (valid)
+      tokens.pop ();
+  }
+
+  bool is_valid () const
+  { return valid && !tokens.in_error () && !masks.in_error (); }
+
+  unsigned get_size () const
+  {
+    return sizeof (*this) +
+	   tokens.allocated * sizeof (tokens.arrayZ[0]) +
+	   masks.allocated * sizeof (masks.arrayZ[0]);
+  }
+
+  hb_vector_t<token_t>		tokens;
+  hb_vector_t<unsigned char>	masks;
+  bool				last_was_number = false;
+  bool				valid = true;
+};
+
+/* Decoded charstrings of a font, indexed by glyph and recorded lazily as
+ * glyphs are first interpreted.  Once the decoded charstrings take more
+ * than HB_CFF_CHARSTRING_CACHE_MAX_BYTES, further glyphs are interpreted
+ * from their bytes. */
+struct decoded_cs_cache_t
+{
+  void init (unsigned num_glyphs_) { num_glyphs = num_glyphs_; }
+  ~decoded_cs_cache_t ()
+  {
+    hb_atomic_ptr_t<decoded_cs_t> *array = glyphs.get_relaxed ();
+    if (!array) return;
+    for (unsigned i = 0; i < num_glyphs; i++)
+      destroy (array[i].get_relaxed ());
+    hb_free (array);
+  }
+
+  const decoded_cs_t *get (hb_codepoint_t glyph) const
+  {
+    hb_atomic_ptr_t<decoded_cs_t> *array = glyphs.get_acquire ();
+    if (!array || glyph >= num_glyphs) return nullptr;
+    return array[glyph].get_acquire ();
+  }
+
+  bool has_room () const
+  { return (unsigned) bytes.get_relaxed () < HB_CFF_CHARSTRING_CACHE_MAX_BYTES; }
+
+  /* Best-effort; allocation failures just leave the glyph uncached. */
+  void set (hb_codepoint_t glyph, decoded_cs_t &recorded)
+  {
+    if (unlikely (glyph >= num_glyphs || !recorded.is_valid ())) return;
+
+  retry:
+    hb_atomic_ptr_t<decoded_cs_t> *array = glyphs.get_acquire ();
+    if (unlikely (!array))
+    {
+      array = (hb_atomic_ptr_t<decoded_cs_t> *) hb_calloc (num_glyphs, sizeof (array[0]));
+      if (unlikely (!array)) return;
+      if (unlikely (!glyphs.cmpexch (nullptr, array)))
+      {
+	hb_free (array);
+	goto retry;
+      }
+    }
+
+    recorded.tokens.alloc (recorded.tokens.length, true);
+    recorded.masks.alloc (recorded.masks.length, true);
+    decoded_cs_t *decoded = (decoded_cs_t *) hb_calloc (1, sizeof (decoded_cs_t));
+    if (unlikely (!decoded)) return;
+    new (decoded) decoded_cs_t (std::move (recorded));
+
+    if (unlikely (!array[glyph].cmpexch (nullptr, decoded)))
+    {
+      destroy (decoded); /* Another thread beat us to it. */
+      return;
+    }
+    hb_atomic_int_impl_add (&bytes.v, (int) decoded->get_size ());
+  }
+
+  private:
+  static void destroy (decoded_cs_t *decoded)
+  {
+    if (!decoded) return;
+    decoded->~decoded_cs_t ();
+    hb_free (decoded);
+  }
+
+  mutable hb_atomic_ptr_t<hb_atomic_ptr_t<decoded_cs_t>> glyphs;
+  hb_atomic_int_t bytes;
+  unsigned num_glyphs = 0;
+};
+
 template <typename ENV, typename OPSET, typename PARAM>
 struct cs_interpreter_t : interpreter_t<ENV>
 {
   cs_interpreter_t (ENV& env_) : interpreter_t<ENV> (env_) {}
 
-  bool interpret (PARAM& param)
+  /* If decoded is given, the charstring is recorded into it as it is
+   * interpreted. */
+  bool interpret (PARAM& param, decoded_cs_t *decoded = nullptr)
   {
     SUPER::env.set_endchar (false);
 
     unsigned max_ops = HB_CFF_MAX_OPS;
     for (;;) {
-      OPSET::process_op (SUPER::env.fetch_op (), SUPER::env, param);
+      op_code_t op = SUPER::env.fetch_op ();
+      unsigned start = SUPER::env.str_ref.get_offset ();
+      OPSET::process_op (op, SUPER::env, param);
       if (unlikely (SUPER::env.in_error () || !--max_ops))
       {
 	SUPER::env.set_error ();
 	return false;
       }
+      if (decoded)
+	record (*decoded, op, start);
       if (SUPER::env.is_endchar ())
 	break;
     }
@@ -896,7 +1044,91 @@ struct cs_interpreter_t : interpreter_t<ENV>
     return true;
   }
 
+  /* Interprets the charstring of glyph, replaying it from cache if it
+   * was decoded before, and recording it into the cache otherwise. */
+  bool interpret (PARAM& param, decoded_cs_cache_t &cache, hb_codepoint_t glyph)
+  {
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+    const decoded_cs_t *decoded = cache.get (glyph);
+    if (decoded)
+      return replay (param, *decoded);
+
+    if (cache.has_room ())
+    {
+      decoded_cs_t recorded;
+      if (unlikely (!interpret (param, &recorded)))
+	return false;
+      cache.set (glyph, recorded);
+      return true;
+    }
+#endif
+
+    return interpret (param);
+  }
+
+  bool replay (PARAM& param, const decoded_cs_t &decoded)
+  {
+    ENV &env = SUPER::env;
+    env.set_endchar (false);
+
+    const unsigned char *mask = decoded.masks.arrayZ;
+    for (const auto &token : decoded.tokens)
+    {
+      if (token.op == OpCode_fixedcs)
+	env.argStack.push_fixed (token.value);
+      else
+      {
+	if (token.op == OpCode_hintmask || token.op == OpCode_cntrmask)
+	{
+	  env.str_ref.reset (hb_ubytes_t (mask, token.value));
+	  mask += token.value;
+	}
+	OPSET::process_op (token.op, env, param);
+      }
+      if (unlikely (env.in_error ()))
+	return false;
+      if (env.is_endchar ())
+	break;
+    }
+
+    return true;
+  }
+
   private:
+  void record (decoded_cs_t &decoded, op_code_t op, unsigned start)
+  {
+    ENV &env = SUPER::env;
+    if (OPSET::is_number_op (op))
+    {
+      decoded.push_number (env.argStack.peek ().to_fixed ());
+      return;
+    }
+
+    switch (op)
+    {
+      case OpCode_callsubr:
+      case OpCode_callgsubr:
+	decoded.pop_call ();
+	return;
+      case OpCode_return:
+	return;
+
+      case OpCode_hintmask:
+      case OpCode_cntrmask:
+	decoded.push_mask (op, env.str_ref.sub_array (start, env.str_ref.get_offset () - start));
+	return;
+
+      case OpCode_blendcs:
+      case OpCode_vsindexcs:
+	decoded.check_literal_operand ();
+	break;
+
+      default:
+	break;
+    }
+    decoded.push_op (op);
+  }
+
   typedef interpreter_t<ENV> SUPER;
 };
 
@@ -70,11 +70,13 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<ELEM, CFF2Subrs>
 {
   template <typename ACC>
   cff2_cs_interp_env_t (const hb_ubytes_t &str, ACC &acc, unsigned int fd,
-			const int *coords_=nullptr, unsigned int num_coords_=0)
+			const int *coords_=nullptr, unsigned int num_coords_=0,
+			ItemVariationStore::cache_t *region_cache_=nullptr)
     : SUPER (str, acc.globalSubrs, acc.privateDicts[fd].localSubrs)
   {
     coords = coords_;
     num_coords = num_coords_;
+    region_cache = region_cache_;
     varStore = acc.varStore;
     do_blend = num_coords && coords && varStore->size;
     set_ivs (acc.privateDicts[fd].ivs);
@@ -118,7 +120,8 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<ELEM, CFF2Subrs>
 	  SUPER::set_error ();
 	else
 	  varStore->varStore.get_region_scalars (get_ivs (), coords, num_coords,
-						 &scalars[0], region_count);
+						 &scalars[0], region_count,
+						 region_cache);
       }
       seen_blend = true;
     }
@@ -164,6 +167,7 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<ELEM, CFF2Subrs>
   protected:
   const int     *coords;
   unsigned int  num_coords;
+  ItemVariationStore::cache_t *region_cache;
   const	 CFF2ItemVariationStore *varStore;
   unsigned int  region_count;
   unsigned int  ivs;
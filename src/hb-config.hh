@@ -151,6 +151,10 @@
 #define HB_NO_OUTLINE
 #endif
 
+#ifdef HB_NO_OUTLINE
+#define HB_NO_FONT_OUTLINE_CACHE
+#endif
+
 #ifdef HB_NO_GETENV
 #define HB_NO_UNISCRIBE_BUG_COMPATIBLE
 #endif
@@ -191,10 +195,15 @@
 #endif
 
 #ifdef HB_MINIMIZE_MEMORY_USAGE
+#define HB_NO_AAT_LAYOUT_CLASS_CACHE
+#define HB_NO_CFF_CHARSTRING_CACHE
 #define HB_NO_GDEF_CACHE
 #define HB_NO_OT_LAYOUT_LOOKUP_CACHE
+#define HB_NO_OT_LAYOUT_LOOKUP_DISPATCH
+#define HB_NO_OT_LAYOUT_GLYPH_MAP
 #define HB_NO_OT_FONT_ADVANCE_CACHE
 #define HB_NO_OT_FONT_CMAP_CACHE
+#define HB_NO_OT_FONT_EXTENTS_CACHE
 #endif
 
 #ifdef HB_OPTIMIZE_SIZE
@@ -362,6 +362,10 @@ struct hb_no_trace_t {
 #define HB_DEBUG_BLOB (HB_DEBUG+0)
 #endif
 
+#ifndef HB_DEBUG_CACHE
+#define HB_DEBUG_CACHE (HB_DEBUG+0)
+#endif
+
 #ifndef HB_DEBUG_CORETEXT
 #define HB_DEBUG_CORETEXT (HB_DEBUG+0)
 #endif
@@ -311,12 +311,22 @@ hb_face_destroy (hb_face_t *face)
   if (!hb_object_destroy (face)) return;
 
 #ifndef HB_NO_SHAPER
-  for (hb_face_t::plan_node_t *node = face->shape_plans; node; )
+  hb_face_t::plan_cache_t *plan_cache = face->shape_plans.get_relaxed ();
+  if (plan_cache)
   {
-    hb_face_t::plan_node_t *next = node->next;
-    hb_shape_plan_destroy (node->shape_plan);
-    hb_free (node);
-    node = next;
+    for (auto &bucket : plan_cache->buckets)
+    {
+      for (auto &plan : bucket.plans)
+	hb_shape_plan_destroy (plan.get_relaxed ());
+      for (hb_face_t::plan_node_t *node = bucket.retired.get_relaxed (); node; )
+      {
+	hb_face_t::plan_node_t *next = node->next;
+	hb_shape_plan_destroy (node->shape_plan);
+	hb_free (node);
+	node = next;
+      }
+    }
+    hb_free (plan_cache);
   }
 #endif
 
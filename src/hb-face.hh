@@ -40,6 +40,13 @@
  * hb_face_t
  */
 
+#ifndef HB_SHAPE_PLAN_CACHE_BUCKETS
+#define HB_SHAPE_PLAN_CACHE_BUCKETS 32
+#endif
+#ifndef HB_SHAPE_PLAN_CACHE_MAX_PLANS
+#define HB_SHAPE_PLAN_CACHE_MAX_PLANS 256
+#endif
+
 #define HB_SHAPER_IMPLEMENT(shaper) HB_SHAPER_DATA_INSTANTIATE_SHAPERS(shaper, face);
 #include "hb-shaper-list.hh"
 #undef HB_SHAPER_IMPLEMENT
@@ -69,8 +76,28 @@ struct hb_face_t
     hb_shape_plan_t *shape_plan;
     plan_node_t *next;
   };
+  struct plan_bucket_t
+  {
+    static constexpr unsigned WAYS = hb_max (1u, (unsigned) HB_SHAPE_PLAN_CACHE_MAX_PLANS / HB_SHAPE_PLAN_CACHE_BUCKETS);
+
+    hb_atomic_ptr_t<hb_shape_plan_t> plans[WAYS];
+    hb_atomic_int_t last_used[WAYS];	/* Values of clock; the oldest is evicted. */
+    hb_atomic_int_t clock;
+    hb_atomic_int_t readers;		/* Threads looking at plans. */
+    hb_atomic_ptr_t<plan_node_t> retired;	/* Evicted plans, destroyed once there are no readers. */
+    hb_atomic_int_t hits;
+    hb_atomic_int_t misses;
+    hb_atomic_int_t evictions;
+  };
+  struct plan_cache_t
+  {
+    plan_bucket_t buckets[HB_SHAPE_PLAN_CACHE_BUCKETS];
+  };
 #ifndef HB_NO_SHAPER
-  hb_atomic_ptr_t<plan_node_t> shape_plans;
+  /* Shape plans, set-associative by the plan key hash; allocated on first
+   * use.  Lookups and replacements are lock-free; see
+   * hb_shape_plan_create_cached2(). */
+  hb_atomic_ptr_t<plan_cache_t> shape_plans;
 #endif
 
   hb_blob_t *reference_table (hb_tag_t tag) const
@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_FONT_OUTLINE_CACHE_HH
+#define HB_FONT_OUTLINE_CACHE_HH
+
+#include "hb.hh"
+
+#include "hb-map.hh"
+#include "hb-mutex.hh"
+#include "hb-outline.hh"
+
+
+#ifndef HB_NO_FONT_OUTLINE_CACHE
+
+/* A cache of glyph outlines, as drawn by hb_font_t::draw_glyph ().
+ *
+ * Outlines are recorded with the outline recording pen and replayed
+ * through the draw funcs of later calls.  All entries were drawn at the
+ * same font serial; when the font changes in any way, including its
+ * variation coords, the whole cache is dropped.
+ *
+ * Entries are kept in a doubly-linked LRU list; when the outlines held
+ * take more than max_bytes, the least-recently-used ones are evicted.
+ * Entries are reference-counted, so that replaying, which calls into
+ * user code, happens outside the lock and an entry evicted meanwhile
+ * stays alive until the replay is done.
+ */
+
+struct hb_font_outline_cache_t
+{
+  struct entry_t
+  {
+    hb_atomic_int_t ref_count;
+    hb_codepoint_t glyph;
+    unsigned size;
+    entry_t *prev;
+    entry_t *next;
+    hb_outline_t outline;
+
+    static entry_t *create (hb_codepoint_t glyph, hb_outline_t &&outline)
+    {
+      entry_t *e = (entry_t *) hb_calloc (1, sizeof (entry_t));
+      if (unlikely (!e)) return nullptr;
+      new (e) entry_t ();
+      e->ref_count = 1;
+      e->glyph = glyph;
+      e->outline = std::move (outline);
+      e->size = sizeof (entry_t) +
+		e->outline.points.allocated * sizeof (e->outline.points.arrayZ[0]) +
+		e->outline.contours.allocated * sizeof (e->outline.contours.arrayZ[0]);
+      return e;
+    }
+
+    static void release (entry_t *e)
+    {
+      if (e->ref_count.dec () != 1) return;
+      e->~entry_t ();
+      hb_free (e);
+    }
+  };
+
+  hb_font_outline_cache_t (unsigned max_bytes_) : max_bytes (max_bytes_) {}
+  ~hb_font_outline_cache_t () { clear (); }
+
+  hb_mutex_t lock;
+  unsigned max_bytes;
+  unsigned bytes = 0;
+  unsigned serial = 0;
+  hb_hashmap_t<hb_codepoint_t, entry_t *> map;
+  entry_t *head = nullptr; /* Most-recently used. */
+  entry_t *tail = nullptr; /* Least-recently used. */
+
+  hb_atomic_int_t hits;
+  hb_atomic_int_t misses;
+  hb_atomic_int_t evictions;
+
+  void unlink (entry_t *e)
+  {
+    if (e->prev) e->prev->next = e->next; else head = e->next;
+    if (e->next) e->next->prev = e->prev; else tail = e->prev;
+    e->prev = e->next = nullptr;
+  }
+
+  void link_front (entry_t *e)
+  {
+    e->prev = nullptr;
+    e->next = head;
+    if (head) head->prev = e;
+    head = e;
+    if (!tail) tail = e;
+  }
+
+  void evict (entry_t *e)
+  {
+    unlink (e);
+    map.del (e->glyph);
+    bytes -= e->size;
+    entry_t::release (e);
+  }
+
+  /* Drops everything if the font changed since the entries were drawn. */
+  void check_serial (unsigned font_serial)
+  {
+    if (serial == font_serial) return;
+    clear_locked ();
+    serial = font_serial;
+  }
+
+  /* Returns a reference to the outline of glyph, to be released with
+   * entry_t::release (), or nullptr on a miss. */
+  entry_t *lookup (hb_codepoint_t glyph, unsigned font_serial)
+  {
+    hb_lock_t l (lock);
+    check_serial (font_serial);
+
+    entry_t *e = map.get (glyph);
+    if (!e)
+    {
+      misses.inc ();
+      return nullptr;
+    }
+
+    if (head != e)
+    {
+      unlink (e);
+      link_front (e);
+    }
+    e->ref_count.inc ();
+    hits.inc ();
+    return e;
+  }
+
+  /* Records the outline of glyph as drawn at font_serial.  Best-effort;
+   * outlines that don't fit, or allocation failures, just leave the
+   * glyph uncached. */
+  void insert (hb_codepoint_t glyph, unsigned font_serial, hb_outline_t &&outline)
+  {
+    outline.points.alloc (outline.points.length, true);
+    outline.contours.alloc (outline.contours.length, true);
+
+    hb_lock_t l (lock);
+    check_serial (font_serial);
+    if (font_serial != serial || map.has (glyph))
+      return; /* The font changed again, or another thread beat us to it. */
+
+    entry_t *e = entry_t::create (glyph, std::move (outline));
+    if (unlikely (!e)) return;
+    if (e->size > max_bytes)
+    {
+      entry_t::release (e);
+      return;
+    }
+
+    while (tail && bytes + e->size > max_bytes)
+    {
+      evict (tail);
+      evictions.inc ();
+    }
+
+    if (unlikely (!map.set (glyph, e)))
+    {
+      entry_t::release (e);
+      return;
+    }
+    link_front (e);
+    bytes += e->size;
+  }
+
+  void set_max_bytes (unsigned max_bytes_)
+  {
+    hb_lock_t l (lock);
+    max_bytes = max_bytes_;
+    while (tail && bytes > max_bytes)
+    {
+      evict (tail);
+      evictions.inc ();
+    }
+  }
+
+  void clear_locked ()
+  {
+    while (tail)
+      evict (tail);
+    map.reset ();
+  }
+
+  void clear ()
+  {
+    hb_lock_t l (lock);
+    clear_locked ();
+  }
+};
+
+#endif
+
+
+#endif /* HB_FONT_OUTLINE_CACHE_HH */
@@ -29,6 +29,7 @@
 #include "hb.hh"
 
 #include "hb-font.hh"
+#include "hb-font-outline-cache.hh"
 #include "hb-draw.hh"
 #include "hb-paint.hh"
 #include "hb-machinery.hh"
@@ -1435,6 +1436,37 @@ hb_font_draw_glyph (hb_font_t *font,
   font->draw_glyph (glyph, dfuncs, draw_data);
 }
 
+#ifndef HB_NO_FONT_OUTLINE_CACHE
+void
+hb_font_t::draw_glyph_cached (hb_codepoint_t glyph,
+			      hb_draw_funcs_t *draw_funcs, void *draw_data)
+{
+  unsigned font_serial = serial;
+  hb_font_outline_cache_t::entry_t *entry = outline_cache->lookup (glyph, font_serial);
+  if (entry)
+  {
+    entry->outline.replay (draw_funcs, draw_data);
+    hb_font_outline_cache_t::entry_t::release (entry);
+    return;
+  }
+
+  hb_outline_t outline;
+  klass->get.f.draw_glyph (this, user_data,
+			   glyph,
+			   hb_outline_recording_pen_get_funcs (), &outline,
+			   !klass->user_data ? nullptr : klass->user_data->draw_glyph);
+  /* Close a trailing contour the font funcs left open. */
+  if (outline.points.length && (!outline.contours.length ||
+				outline.contours.tail () != outline.points.length))
+    outline.contours.push (outline.points.length);
+
+  outline.replay (draw_funcs, draw_data);
+
+  if (likely (!outline.points.in_error () && !outline.contours.in_error ()))
+    outline_cache->insert (glyph, font_serial, std::move (outline));
+}
+#endif
+
 /**
  * hb_font_paint_glyph:
  * @font: #hb_font_t to work upon
@@ -1880,6 +1912,7 @@ _hb_font_adopt_var_coords (hb_font_t *font,
   font->design_coords = design_coords;
   font->num_coords = coords_length;
 
+  font->drop_var_store_caches ();
   font->mults_changed (); // Easiest to call this to drop cached data
 }
 
@@ -1987,6 +2020,14 @@ hb_font_destroy (hb_font_t *font)
   if (!hb_object_destroy (font)) return;
 
   font->data.fini ();
+  font->drop_var_store_caches ();
+#ifndef HB_NO_FONT_OUTLINE_CACHE
+  if (font->outline_cache)
+  {
+    font->outline_cache->~hb_font_outline_cache_t ();
+    hb_free (font->outline_cache);
+  }
+#endif
 
   if (font->destroy)
     font->destroy (font->user_data);
@@ -2122,6 +2163,102 @@ hb_font_changed (hb_font_t *font)
   font->mults_changed ();
 }
 
+/**
+ * hb_font_set_outline_cache_size:
+ * @font: #hb_font_t to work upon
+ * @max_bytes: Memory budget for cached outlines, in bytes, or zero to
+ *    disable the cache
+ *
+ * Sets up a cache of glyph outlines on @font.  Glyphs drawn with
+ * hb_font_draw_glyph() are recorded in the cache and later draws of the
+ * same glyph replay the recorded outline into the draw functions instead
+ * of decoding the glyph again.
+ *
+ * The cache is dropped whenever @font changes in a way that bumps its
+ * serial, including changes to its variation coordinates.  Outlines are
+ * evicted, least-recently drawn first, to keep the cache within
+ * @max_bytes.  The cache is off by default.
+ *
+ * If @font has a parent, call hb_font_changed() on @font after changing
+ * the parent, so that outlines drawn through the parent are dropped.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_font_set_outline_cache_size (hb_font_t    *font,
+				unsigned int  max_bytes)
+{
+#ifndef HB_NO_FONT_OUTLINE_CACHE
+  if (hb_object_is_immutable (font))
+    return;
+
+  if (!max_bytes)
+  {
+    if (font->outline_cache)
+    {
+      font->outline_cache->~hb_font_outline_cache_t ();
+      hb_free (font->outline_cache);
+      font->outline_cache = nullptr;
+    }
+    return;
+  }
+
+  if (font->outline_cache)
+  {
+    font->outline_cache->set_max_bytes (max_bytes);
+    return;
+  }
+
+  auto *cache = (hb_font_outline_cache_t *) hb_calloc (1, sizeof (hb_font_outline_cache_t));
+  if (unlikely (!cache))
+    return;
+  font->outline_cache = new (cache) hb_font_outline_cache_t (max_bytes);
+#endif
+}
+
+/**
+ * hb_font_get_outline_cache_stats:
+ * @font: #hb_font_t to work upon
+ * @hits: (out) (optional): Number of glyphs drawn from the cache
+ * @misses: (out) (optional): Number of glyphs that had to be decoded
+ * @evictions: (out) (optional): Number of outlines evicted to stay within
+ *    the memory budget
+ * @bytes: (out) (optional): Memory currently used by cached outlines
+ *
+ * Fetches statistics of the outline cache of @font, as set up with
+ * hb_font_set_outline_cache_size().  Counts are zero if @font has no
+ * outline cache.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_font_get_outline_cache_stats (hb_font_t    *font,
+				 unsigned int *hits,
+				 unsigned int *misses,
+				 unsigned int *evictions,
+				 unsigned int *bytes)
+{
+  if (hits) *hits = 0;
+  if (misses) *misses = 0;
+  if (evictions) *evictions = 0;
+  if (bytes) *bytes = 0;
+
+#ifndef HB_NO_FONT_OUTLINE_CACHE
+  hb_font_outline_cache_t *cache = font->outline_cache;
+  if (!cache)
+    return;
+
+  if (hits) *hits = cache->hits;
+  if (misses) *misses = cache->misses;
+  if (evictions) *evictions = cache->evictions;
+  if (bytes)
+  {
+    hb_lock_t l (cache->lock);
+    *bytes = cache->bytes;
+  }
+#endif
+}
+
 /**
  * hb_font_set_parent:
  * @font: #hb_font_t to work upon
@@ -2197,6 +2334,7 @@ hb_font_set_face (hb_font_t *font,
 
   hb_face_make_immutable (face);
   font->face = hb_face_reference (face);
+  font->drop_var_store_caches ();
   font->mults_changed ();
 
   hb_face_destroy (old);
@@ -1025,6 +1025,17 @@ hb_font_get_serial (hb_font_t *font);
 HB_EXTERN void
 hb_font_changed (hb_font_t *font);
 
+HB_EXTERN void
+hb_font_set_outline_cache_size (hb_font_t    *font,
+				unsigned int  max_bytes);
+
+HB_EXTERN void
+hb_font_get_outline_cache_stats (hb_font_t    *font,
+				 unsigned int *hits,
+				 unsigned int *misses,
+				 unsigned int *evictions,
+				 unsigned int *bytes);
+
 HB_EXTERN void
 hb_font_set_parent (hb_font_t *font,
 		    hb_font_t *parent);
@@ -145,6 +145,42 @@ struct hb_font_t
 
   hb_shaper_object_dataset_t<hb_font_t> data; /* Various shaper data. */
 
+  /* Region scalar caches of the ItemVariationStores of the face, valid for
+   * the current coords and shared by everything using the font.  A user
+   * takes a cache out of its slot for as long as it needs it, so concurrent
+   * users never share one; see OT::ItemVariationStore::acquire_cache ().
+   * Each remembers the store it was made for, and is only handed back to
+   * that store. */
+  enum var_store_cache_t
+  {
+    VAR_STORE_CACHE_HVAR,
+    VAR_STORE_CACHE_VVAR,
+    VAR_STORE_CACHE_MVAR,
+    VAR_STORE_CACHE_GDEF,
+    VAR_STORE_CACHE_COLR,
+    VAR_STORE_CACHE_CFF2,
+    VAR_STORE_CACHE_COUNT
+  };
+  struct var_store_cache_entry_t
+  {
+    const void *store;
+    unsigned region_count;
+    float scalars[HB_VAR_ARRAY];
+  };
+  hb_atomic_ptr_t<var_store_cache_entry_t> var_store_caches[VAR_STORE_CACHE_COUNT];
+
+  void drop_var_store_caches ()
+  {
+    for (auto &cache : var_store_caches)
+    {
+      hb_free (cache.get_relaxed ());
+      cache.set_relaxed (nullptr);
+    }
+  }
+
+  /* Optional; see hb_font_set_outline_cache_size (). */
+  struct hb_font_outline_cache_t *outline_cache;
+
 
   /* Convert from font-space to user-space */
   int64_t dir_mult (hb_direction_t direction)
@@ -426,9 +462,19 @@ struct hb_font_t
 					 !klass->user_data ? nullptr : klass->user_data->glyph_from_name);
   }
 
+  HB_INTERNAL void draw_glyph_cached (hb_codepoint_t glyph,
+				      hb_draw_funcs_t *draw_funcs, void *draw_data);
+
   void draw_glyph (hb_codepoint_t glyph,
 		   hb_draw_funcs_t *draw_funcs, void *draw_data)
   {
+#ifndef HB_NO_FONT_OUTLINE_CACHE
+    if (unlikely (outline_cache))
+    {
+      draw_glyph_cached (glyph, draw_funcs, draw_data);
+      return;
+    }
+#endif
     klass->get.f.draw_glyph (this, user_data,
 			     glyph,
 			     draw_funcs, draw_data,
@@ -104,6 +104,10 @@
 #define HB_CFF_MAX_OPS 10000
 #endif
 
+#ifndef HB_CFF_CHARSTRING_CACHE_MAX_BYTES
+#define HB_CFF_CHARSTRING_CACHE_MAX_BYTES (4 << 20)
+#endif
+
 #ifndef HB_MAX_COMPOSITE_OPERATIONS_PER_GLYPH
 #define HB_MAX_COMPOSITE_OPERATIONS_PER_GLYPH 64
 #endif
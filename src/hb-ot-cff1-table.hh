@@ -1362,6 +1362,7 @@ struct cff1
       glyph_names.set_relaxed (nullptr);
 
       if (!is_valid ()) return;
+      charstring_cache.init (num_glyphs);
       if (is_CID ()) return;
     }
     ~accelerator_t ()
@@ -1486,6 +1487,10 @@ struct cff1
 
     mutable hb_atomic_ptr_t<hb_sorted_vector_t<gname_t>> glyph_names;
 
+    public:
+    mutable decoded_cs_cache_t charstring_cache;
+
+    private:
     typedef accelerator_templ_t<cff1_private_dict_opset_t, cff1_private_dict_values_t> SUPER;
   };
 
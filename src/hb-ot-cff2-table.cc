@@ -112,10 +112,13 @@ bool OT::cff2::accelerator_t::get_extents (hb_font_t *font,
 
   unsigned int fd = fdSelect->get_fd (glyph);
   const hb_ubytes_t str = (*charStrings)[glyph];
-  cff2_cs_interp_env_t<number_t> env (str, *this, fd, font->coords, font->num_coords);
+  auto *region_cache = varStore->varStore.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_CFF2);
+  cff2_cs_interp_env_t<number_t> env (str, *this, fd, font->coords, font->num_coords, region_cache);
   cff2_cs_interpreter_t<cff2_cs_opset_extents_t, cff2_extents_param_t, number_t> interp (env);
   cff2_extents_param_t  param;
-  if (unlikely (!interp.interpret (param))) return false;
+  bool ret = interp.interpret (param, charstring_cache, glyph);
+  ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_CFF2, region_cache);
+  if (unlikely (!ret)) return false;
 
   if (param.min_x >= param.max_x)
   {
@@ -215,13 +218,19 @@ bool OT::cff2::accelerator_t::get_path_at (hb_font_t *font, hb_codepoint_t glyph
 
   if (unlikely (!is_valid () || (glyph >= num_glyphs))) return false;
 
+  /* The region scalars kept on the font are only good for its own coords. */
+  auto *region_cache = coords.arrayZ == font->coords
+		     ? varStore->varStore.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_CFF2)
+		     : nullptr;
+
   unsigned int fd = fdSelect->get_fd (glyph);
   const hb_ubytes_t str = (*charStrings)[glyph];
-  cff2_cs_interp_env_t<number_t> env (str, *this, fd, coords.arrayZ, coords.length);
+  cff2_cs_interp_env_t<number_t> env (str, *this, fd, coords.arrayZ, coords.length, region_cache);
   cff2_cs_interpreter_t<cff2_cs_opset_path_t, cff2_path_param_t, number_t> interp (env);
   cff2_path_param_t param (font, draw_session);
-  if (unlikely (!interp.interpret (param))) return false;
-  return true;
+  bool ret = interp.interpret (param, charstring_cache, glyph);
+  ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_CFF2, region_cache);
+  return ret;
 }
 
 #endif
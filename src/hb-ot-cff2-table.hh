@@ -513,7 +513,11 @@ struct cff2
 
   struct accelerator_t : accelerator_templ_t<cff2_private_dict_opset_t, cff2_private_dict_values_t>
   {
-    accelerator_t (hb_face_t *face) : accelerator_templ_t (face) {}
+    accelerator_t (hb_face_t *face) : accelerator_templ_t (face)
+    {
+      if (!is_valid ()) return;
+      charstring_cache.init (num_glyphs);
+    }
 
     HB_INTERNAL bool get_extents (hb_font_t *font,
 				  hb_codepoint_t glyph,
@@ -521,6 +525,8 @@ struct cff2
     HB_INTERNAL bool paint_glyph (hb_font_t *font, hb_codepoint_t glyph, hb_paint_funcs_t *funcs, void *data, hb_color_t foreground) const;
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session) const;
     HB_INTERNAL bool get_path_at (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session, hb_array_t<const int> coords) const;
+
+    mutable decoded_cs_cache_t charstring_cache;
   };
 
   struct accelerator_subset_t : accelerator_templ_t<cff2_private_dict_opset_subset_t, cff2_private_dict_values_subset_t>
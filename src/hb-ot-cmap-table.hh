@@ -2010,7 +2010,7 @@ struct cmap
 
   struct accelerator_t
   {
-    using cache_t = hb_cache_t<21, 16, 8, true>;
+    using cache_t = hb_set_assoc_cache_t<21, 16, 4, true>;
 
     accelerator_t (hb_face_t *face)
     {
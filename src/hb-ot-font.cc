@@ -62,13 +62,109 @@
  * never need to call these functions directly.
  **/
 
-using hb_ot_font_cmap_cache_t    = hb_cache_t<21, 16, 8, true>;
-using hb_ot_font_advance_cache_t = hb_cache_t<24, 16, 8, true>;
+using hb_ot_font_cmap_cache_t    = hb_set_assoc_cache_t<21, 16, 4, true>;
+using hb_ot_font_advance_cache_t = hb_set_assoc_cache_t<20, 16, 4, true>;
+
+/* The cmap and advance caches are sized to the face: one set (of four
+ * items) per sixteen glyphs, between 2^HB_OT_FONT_CACHE_MIN_SET_BITS
+ * and 2^HB_OT_FONT_CACHE_MAX_SET_BITS sets.  Small fonts thus get 256
+ * items (1kb) per cache, as much as before, while CJK fonts with tens
+ * of thousands of glyphs get enough room for the working set of typical
+ * text.  Key and value share one int per item, so the caches never go
+ * below 2^min_set_bits sets; a smaller minimum is raised to that. */
+#ifndef HB_OT_FONT_CACHE_MIN_SET_BITS
+#define HB_OT_FONT_CACHE_MIN_SET_BITS 6
+#endif
+#ifndef HB_OT_FONT_CACHE_MAX_SET_BITS
+#define HB_OT_FONT_CACHE_MAX_SET_BITS 10
+#endif
+
+static unsigned
+hb_ot_font_cache_set_bits (hb_face_t *face)
+{
+  return hb_clamp (hb_bit_storage (face->get_num_glyphs () / 16),
+		   (unsigned) HB_OT_FONT_CACHE_MIN_SET_BITS,
+		   (unsigned) HB_OT_FONT_CACHE_MAX_SET_BITS);
+}
 
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
 static hb_user_data_key_t hb_ot_font_cmap_cache_user_data_key;
 #endif
 
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+/* Lock-free direct-mapped cache of scaled glyph extents.
+ *
+ * An entry does not fit in one atomic word, so each slot is a seqlock:
+ * a writer claims the slot through `busy` (giving up if another writer
+ * holds it), makes `seq` odd while it stores the fields, then even
+ * again.  A reader that sees an odd or changed `seq` treats the lookup
+ * as a miss. */
+struct hb_ot_font_extents_cache_t
+{
+  static constexpr unsigned cache_bits = 8;
+
+  struct item_t
+  {
+    hb_atomic_int_t busy;
+    hb_atomic_int_t seq;
+    hb_atomic_int_t glyph;
+    hb_atomic_int_t x_bearing;
+    hb_atomic_int_t y_bearing;
+    hb_atomic_int_t width;
+    hb_atomic_int_t height;
+  };
+
+  hb_ot_font_extents_cache_t () { clear (); }
+
+  void clear ()
+  {
+    for (auto &item : items)
+      item.glyph = -1;
+  }
+
+  bool get (hb_codepoint_t glyph, hb_glyph_extents_t *extents) const
+  {
+    const item_t &item = items[glyph & ((1u << cache_bits) - 1)];
+    int seq = item.seq.get_acquire ();
+    if (seq & 1)
+      return false;
+    if ((hb_codepoint_t) item.glyph.get_relaxed () != glyph)
+      return false;
+    hb_glyph_extents_t e;
+    e.x_bearing = item.x_bearing.get_relaxed ();
+    e.y_bearing = item.y_bearing.get_relaxed ();
+    e.width = item.width.get_relaxed ();
+    e.height = item.height.get_relaxed ();
+    _hb_memory_r_barrier ();
+    if (item.seq.get_relaxed () != seq)
+      return false;
+    *extents = e;
+    return true;
+  }
+
+  void set (hb_codepoint_t glyph, const hb_glyph_extents_t &extents)
+  {
+    if (unlikely (glyph == (hb_codepoint_t) -1))
+      return;
+    item_t &item = items[glyph & ((1u << cache_bits) - 1)];
+    if (item.busy.inc () == 0)
+    {
+      item.seq.inc ();
+      item.glyph = (int) glyph;
+      item.x_bearing = extents.x_bearing;
+      item.y_bearing = extents.y_bearing;
+      item.width = extents.width;
+      item.height = extents.height;
+      item.seq.inc ();
+    }
+    item.busy.dec ();
+  }
+
+  private:
+  item_t items[1u << cache_bits];
+};
+#endif
+
 struct hb_ot_font_t
 {
   const hb_ot_face_t *ot_face;
@@ -80,6 +176,13 @@ struct hb_ot_font_t
   /* h_advance caching */
   mutable hb_atomic_int_t cached_coords_serial;
   mutable hb_atomic_ptr_t<hb_ot_font_advance_cache_t> advance_cache;
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  /* glyph_extents caching; extents are scaled, so this is
+   * invalidated by any change to the font, not just coords. */
+  mutable hb_atomic_int_t cached_extents_serial;
+  mutable hb_atomic_ptr_t<hb_ot_font_extents_cache_t> extents_cache;
+#endif
 };
 
 static hb_ot_font_t *
@@ -97,16 +200,15 @@ _hb_ot_font_create (hb_font_t *font)
 									 &hb_ot_font_cmap_cache_user_data_key);
   if (!cmap_cache)
   {
-    cmap_cache = (hb_ot_font_cmap_cache_t *) hb_malloc (sizeof (hb_ot_font_cmap_cache_t));
+    cmap_cache = hb_ot_font_cmap_cache_t::create (hb_ot_font_cache_set_bits (font->face));
     if (unlikely (!cmap_cache)) goto out;
-    new (cmap_cache) hb_ot_font_cmap_cache_t ();
     if (unlikely (!hb_face_set_user_data (font->face,
 					  &hb_ot_font_cmap_cache_user_data_key,
 					  cmap_cache,
-					  hb_free,
+					  hb_ot_font_cmap_cache_t::destroy,
 					  false)))
     {
-      hb_free (cmap_cache);
+      hb_ot_font_cmap_cache_t::destroy (cmap_cache);
       cmap_cache = nullptr;
       /* Normally we would retry here, but that would
        * infinite-loop if the face is the empty-face.
@@ -129,7 +231,12 @@ _hb_ot_font_destroy (void *font_data)
   hb_ot_font_t *ot_font = (hb_ot_font_t *) font_data;
 
   auto *cache = ot_font->advance_cache.get_relaxed ();
-  hb_free (cache);
+  hb_ot_font_advance_cache_t::destroy (cache);
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  auto *extents_cache = ot_font->extents_cache.get_relaxed ();
+  hb_free (extents_cache);
+#endif
 
   hb_free (ot_font);
 }
@@ -210,7 +317,7 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
 #if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
   const OT::HVAR &HVAR = *hmtx.var_table;
   const OT::ItemVariationStore &varStore = &HVAR + HVAR.varStore;
-  OT::ItemVariationStore::cache_t *varStore_cache = font->num_coords * count >= 128 ? varStore.create_cache () : nullptr;
+  OT::ItemVariationStore::cache_t *varStore_cache = varStore.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_HVAR);
 
   bool use_cache = font->num_coords;
 #else
@@ -225,17 +332,16 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
     cache = ot_font->advance_cache.get_acquire ();
     if (unlikely (!cache))
     {
-      cache = (hb_ot_font_advance_cache_t *) hb_malloc (sizeof (hb_ot_font_advance_cache_t));
+      cache = hb_ot_font_advance_cache_t::create (hb_ot_font_cache_set_bits (font->face));
       if (unlikely (!cache))
       {
 	use_cache = false;
 	goto out;
       }
-      new (cache) hb_ot_font_advance_cache_t;
 
       if (unlikely (!ot_font->advance_cache.cmpexch (nullptr, cache)))
       {
-	hb_free (cache);
+	hb_ot_font_advance_cache_t::destroy (cache);
 	goto retry;
       }
       ot_font->cached_coords_serial.set_release (font->serial_coords);
@@ -278,7 +384,7 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
   }
 
 #if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
-  OT::ItemVariationStore::destroy_cache (varStore_cache);
+  OT::ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_HVAR, varStore_cache);
 #endif
 
   if (font->x_strength && !font->embolden_in_place)
@@ -315,7 +421,7 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
 #if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
     const OT::VVAR &VVAR = *vmtx.var_table;
     const OT::ItemVariationStore &varStore = &VVAR + VVAR.varStore;
-    OT::ItemVariationStore::cache_t *varStore_cache = font->num_coords ? varStore.create_cache () : nullptr;
+    OT::ItemVariationStore::cache_t *varStore_cache = varStore.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_VVAR);
 #else
     OT::ItemVariationStore::cache_t *varStore_cache = nullptr;
 #endif
@@ -328,7 +434,7 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
     }
 
 #if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
-    OT::ItemVariationStore::destroy_cache (varStore_cache);
+    OT::ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_VVAR, varStore_cache);
 #endif
   }
   else
@@ -418,6 +524,37 @@ hb_ot_get_glyph_v_origin (hb_font_t *font,
 }
 #endif
 
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+static hb_ot_font_extents_cache_t *
+hb_ot_get_extents_cache (hb_font_t *font, const hb_ot_font_t *ot_font)
+{
+retry:
+  hb_ot_font_extents_cache_t *cache = ot_font->extents_cache.get_acquire ();
+  if (unlikely (!cache))
+  {
+    cache = (hb_ot_font_extents_cache_t *) hb_malloc (sizeof (hb_ot_font_extents_cache_t));
+    if (unlikely (!cache))
+      return nullptr;
+    new (cache) hb_ot_font_extents_cache_t;
+
+    if (unlikely (!ot_font->extents_cache.cmpexch (nullptr, cache)))
+    {
+      hb_free (cache);
+      goto retry;
+    }
+    ot_font->cached_extents_serial.set_release (font->serial);
+  }
+
+  if (ot_font->cached_extents_serial.get_acquire () != (int) font->serial)
+  {
+    cache->clear ();
+    ot_font->cached_extents_serial.set_release (font->serial);
+  }
+
+  return cache;
+}
+#endif
+
 static hb_bool_t
 hb_ot_get_glyph_extents (hb_font_t *font,
 			 void *font_data,
@@ -435,13 +572,28 @@ hb_ot_get_glyph_extents (hb_font_t *font,
 #if !defined(HB_NO_COLOR) && !defined(HB_NO_PAINT)
   if (ot_face->COLR->get_extents (font, glyph, extents)) return true;
 #endif
-  if (ot_face->glyf->get_extents (font, glyph, extents)) return true;
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  /* Only outline extents are cached; the bitmap and COLR paths above
+   * are either cheap or depend on more than the glyph. */
+  hb_ot_font_extents_cache_t *cache = hb_ot_get_extents_cache (font, ot_font);
+  if (cache && cache->get (glyph, extents))
+    return true;
+#endif
+
+  bool ret = false;
+  if (ot_face->glyf->get_extents (font, glyph, extents)) ret = true;
 #ifndef HB_NO_OT_FONT_CFF
-  if (ot_face->cff2->get_extents (font, glyph, extents)) return true;
-  if (ot_face->cff1->get_extents (font, glyph, extents)) return true;
+  else if (ot_face->cff2->get_extents (font, glyph, extents)) ret = true;
+  else if (ot_face->cff1->get_extents (font, glyph, extents)) ret = true;
 #endif
 
-  return false;
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  if (ret && cache)
+    cache->set (glyph, *extents);
+#endif
+
+  return ret;
 }
 
 #ifndef HB_NO_OT_FONT_GLYPH_NAMES
@@ -659,4 +811,56 @@ hb_ot_font_set_funcs (hb_font_t *font)
 		     _hb_ot_font_destroy);
 }
 
+/**
+ * hb_ot_font_get_cache_stats:
+ * @font: #hb_font_t to work upon
+ * @cmap_hits: (out) (optional): Number of nominal-glyph lookups served by the cache
+ * @cmap_misses: (out) (optional): Number of nominal-glyph lookups that missed it
+ * @advance_hits: (out) (optional): Number of glyph advances served by the cache
+ * @advance_misses: (out) (optional): Number of glyph advances that missed it
+ *
+ * Fetches hit and miss counts of the glyph caches of @font, which must
+ * be using the functions set by hb_ot_font_set_funcs().  Useful for
+ * tuning `HB_OT_FONT_CACHE_MIN_SET_BITS` and `HB_OT_FONT_CACHE_MAX_SET_BITS`.
+ *
+ * The cmap cache is shared by all fonts on the same face, and so are its
+ * counts.  The advance cache is only used for variable fonts with
+ * coordinates set.
+ *
+ * Return value: `true` if @font uses the functions set by
+ * hb_ot_font_set_funcs(), `false` otherwise, in which case all counts
+ * are set to zero.
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_ot_font_get_cache_stats (hb_font_t    *font,
+			    unsigned int *cmap_hits,
+			    unsigned int *cmap_misses,
+			    unsigned int *advance_hits,
+			    unsigned int *advance_misses)
+{
+  unsigned dummy;
+  if (!cmap_hits) cmap_hits = &dummy;
+  if (!cmap_misses) cmap_misses = &dummy;
+  if (!advance_hits) advance_hits = &dummy;
+  if (!advance_misses) advance_misses = &dummy;
+  *cmap_hits = *cmap_misses = *advance_hits = *advance_misses = 0;
+
+  if (unlikely (font->destroy != (hb_destroy_func_t) _hb_ot_font_destroy))
+    return false;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font->user_data;
+
+#ifndef HB_NO_OT_FONT_CMAP_CACHE
+  if (ot_font->cmap_cache)
+    ot_font->cmap_cache->get_stats (cmap_hits, cmap_misses);
+#endif
+
+  auto *advance_cache = ot_font->advance_cache.get_acquire ();
+  if (advance_cache)
+    advance_cache->get_stats (advance_hits, advance_misses);
+
+  return true;
+}
+
 #endif
@@ -39,6 +39,13 @@ HB_BEGIN_DECLS
 HB_EXTERN void
 hb_ot_font_set_funcs (hb_font_t *font);
 
+HB_EXTERN hb_bool_t
+hb_ot_font_get_cache_stats (hb_font_t    *font,
+			    unsigned int *cmap_hits,
+			    unsigned int *cmap_misses,
+			    unsigned int *advance_hits,
+			    unsigned int *advance_misses);
+
 
 HB_END_DECLS
 
@@ -2307,6 +2307,173 @@ static inline bool ClassDef_serialize (hb_serialize_context_t *c,
 { return (c->start_embed<ClassDef> ()->serialize (c, it)); }
 
 
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+
+#ifndef HB_OT_LAYOUT_GLYPH_MAP_MIN_GLYPHS
+#define HB_OT_LAYOUT_GLYPH_MAP_MIN_GLYPHS 16
+#endif
+#ifndef HB_OT_LAYOUT_GLYPH_MAP_MAX_BYTES
+#define HB_OT_LAYOUT_GLYPH_MAP_MAX_BYTES 16384
+#endif
+
+/* A native-endian copy of a Coverage or ClassDef, for answering
+ * get_coverage() and get_class() without binary-searching big-endian
+ * records.
+ *
+ * Compact glyph ranges are stored as a dense array of values indexed by
+ * glyph id.  Sparse ones are stored as glyph / value arrays in Eytzinger
+ * (breadth-first binary tree) order, which searches without branch
+ * mispredictions and with one cache line per level near the root.
+ * Tables that would need more than max_bytes are not accelerated. */
+struct glyph_map_accelerator_t
+{
+  static constexpr unsigned NO_VALUE = 0xFFFFu;
+
+  bool init (const Coverage &coverage, unsigned max_bytes = HB_OT_LAYOUT_GLYPH_MAP_MAX_BYTES)
+  {
+    unsigned population = coverage.get_population ();
+    if (population < HB_OT_LAYOUT_GLYPH_MAP_MIN_GLYPHS ||
+	population > max_bytes / sizeof (uint16_t))
+      return false;
+
+    hb_vector_t<hb_pair_t<hb_codepoint_t, unsigned>> pairs;
+    if (unlikely (!pairs.alloc (population, true)))
+      return false;
+    for (hb_codepoint_t g : coverage.iter ())
+      pairs.push (hb_pair (g, coverage.get_coverage (g)));
+
+    return init (&coverage, pairs, NOT_COVERED, max_bytes);
+  }
+
+  bool init (const ClassDef &class_def, unsigned max_bytes = HB_OT_LAYOUT_GLYPH_MAP_MAX_BYTES)
+  {
+    /* ClassDef format 1 is already a direct array lookup. */
+    if (class_def.cost () <= 1)
+      return false;
+    unsigned population = class_def.get_population ();
+    if (population < HB_OT_LAYOUT_GLYPH_MAP_MIN_GLYPHS ||
+	population > max_bytes / sizeof (uint16_t))
+      return false;
+
+    hb_set_t glyphs;
+    class_def.collect_coverage (&glyphs);
+    hb_vector_t<hb_pair_t<hb_codepoint_t, unsigned>> pairs;
+    if (unlikely (glyphs.in_error () || !pairs.alloc (glyphs.get_population (), true)))
+      return false;
+    for (hb_codepoint_t g : glyphs)
+      pairs.push (hb_pair (g, class_def.get_class (g)));
+
+    return init (&class_def, pairs, 0, max_bytes);
+  }
+
+  void fini ()
+  {
+    hb_free (values);
+    hb_free (keys);
+    source = nullptr;
+    values = nullptr;
+    keys = nullptr;
+  }
+
+  bool is_for (const void *table) const { return source == table; }
+
+  unsigned get (hb_codepoint_t g) const
+  {
+    unsigned v;
+    if (!keys)
+    {
+      unsigned i = g - start;
+      v = i < length ? values[i] : NO_VALUE;
+    }
+    else
+    {
+      unsigned i = 1;
+      while (i <= length)
+	i = 2 * i + (keys[i] < g);
+      i >>= hb_ctz (~i) + 1;
+      v = i && keys[i] == g ? values[i] : NO_VALUE;
+    }
+    return v == NO_VALUE ? default_value : v;
+  }
+
+  private:
+  bool init (const void *source_,
+	     const hb_vector_t<hb_pair_t<hb_codepoint_t, unsigned>> &pairs,
+	     unsigned default_value_,
+	     unsigned max_bytes)
+  {
+    if (unlikely (pairs.in_error () || !pairs.length))
+      return false;
+    for (unsigned i = 0; i < pairs.length; i++)
+      if (unlikely (pairs.arrayZ[i].second >= NO_VALUE ||
+		    (i && pairs.arrayZ[i].first <= pairs.arrayZ[i - 1].first)))
+	return false; /* Unrepresentable or unsorted. */
+
+    hb_codepoint_t first = pairs.arrayZ[0].first;
+    unsigned span = pairs.tail ().first - first + 1;
+
+    if (span <= max_bytes / sizeof (uint16_t) &&
+	span <= 4 * pairs.length + 64)
+    {
+      /* Dense. */
+      values = (uint16_t *) hb_malloc (span * sizeof (uint16_t));
+      if (unlikely (!values))
+	return false;
+      for (unsigned i = 0; i < span; i++)
+	values[i] = NO_VALUE;
+      for (auto &_ : pairs)
+	values[_.first - first] = _.second;
+      start = first;
+      length = span;
+    }
+    else if (pairs.length <= max_bytes / (sizeof (hb_codepoint_t) + sizeof (uint16_t)))
+    {
+      /* Sparse; 1-based Eytzinger order. */
+      unsigned count = pairs.length;
+      keys = (hb_codepoint_t *) hb_malloc ((count + 1) * sizeof (hb_codepoint_t));
+      values = (uint16_t *) hb_malloc ((count + 1) * sizeof (uint16_t));
+      if (unlikely (!keys || !values))
+      {
+	fini ();
+	return false;
+      }
+      keys[0] = 0;
+      values[0] = NO_VALUE;
+      length = count;
+      eytzinger_fill (pairs, 0, 1);
+    }
+    else
+      return false;
+
+    source = source_;
+    default_value = default_value_;
+    return true;
+  }
+
+  unsigned eytzinger_fill (const hb_vector_t<hb_pair_t<hb_codepoint_t, unsigned>> &pairs,
+			   unsigned i, unsigned k)
+  {
+    if (k <= length)
+    {
+      i = eytzinger_fill (pairs, i, 2 * k);
+      keys[k] = pairs.arrayZ[i].first;
+      values[k] = pairs.arrayZ[i].second;
+      i = eytzinger_fill (pairs, i + 1, 2 * k + 1);
+    }
+    return i;
+  }
+
+  const void *source;
+  hb_codepoint_t start;
+  unsigned length;
+  unsigned default_value;
+  uint16_t *values;
+  hb_codepoint_t *keys; /* Sparse only. */
+};
+
+#endif
+
+
 /*
  * Item Variation Store
  */
@@ -2825,11 +2992,12 @@ struct VarData
   void get_region_scalars (const int *coords, unsigned int coord_count,
 			   const VarRegionList &regions,
 			   float *scalars /*OUT */,
-			   unsigned int num_scalars) const
+			   unsigned int num_scalars,
+			   VarRegionList::cache_t *cache = nullptr) const
   {
     unsigned count = hb_min (num_scalars, regionIndices.len);
     for (unsigned int i = 0; i < count; i++)
-      scalars[i] = regions.evaluate (regionIndices.arrayZ[i], coords, coord_count);
+      scalars[i] = regions.evaluate (regionIndices.arrayZ[i], coords, coord_count, cache);
     for (unsigned int i = count; i < num_scalars; i++)
       scalars[i] = 0.f;
   }
@@ -3200,6 +3368,48 @@ struct ItemVariationStore
 
   static void destroy_cache (cache_t *cache) { hb_free (cache); }
 
+  /* Takes the region scalar cache for this store out of @font, for the
+   * font's current coords, or creates one if it's in use elsewhere.  Hand
+   * it back with release_cache (). */
+  cache_t *acquire_cache (hb_font_t *font, hb_font_t::var_store_cache_t slot) const
+  {
+#ifdef HB_NO_VAR
+    return nullptr;
+#endif
+    if (!font->num_coords) return nullptr;
+
+    unsigned count = (this+regions).regionCount;
+
+    auto &font_cache = font->var_store_caches[slot];
+    auto *entry = font_cache.get_acquire ();
+    if (entry && font_cache.cmpexch (entry, nullptr))
+    {
+      if (likely (entry->store == this && entry->region_count == count))
+	return entry->scalars;
+      hb_free (entry); /* Made for another store, eg. of a previous face. */
+    }
+
+    entry = (hb_font_t::var_store_cache_entry_t *)
+	    hb_malloc (offsetof (hb_font_t::var_store_cache_entry_t, scalars) + sizeof (float) * count);
+    if (unlikely (!entry)) return nullptr;
+
+    entry->store = this;
+    entry->region_count = count;
+    for (unsigned i = 0; i < count; i++)
+      entry->scalars[i] = REGION_CACHE_ITEM_CACHE_INVALID;
+
+    return entry->scalars;
+  }
+
+  static void release_cache (hb_font_t *font, hb_font_t::var_store_cache_t slot, cache_t *cache)
+  {
+    if (!cache) return;
+    auto *entry = (hb_font_t::var_store_cache_entry_t *)
+		  ((char *) cache - offsetof (hb_font_t::var_store_cache_entry_t, scalars));
+    if (!font->var_store_caches[slot].cmpexch (nullptr, entry))
+      hb_free (entry);
+  }
+
   private:
   float get_delta (unsigned int outer, unsigned int inner,
 		   const int *coords, unsigned int coord_count,
@@ -3390,7 +3600,8 @@ struct ItemVariationStore
   void get_region_scalars (unsigned int major,
 			   const int *coords, unsigned int coord_count,
 			   float *scalars /*OUT*/,
-			   unsigned int num_scalars) const
+			   unsigned int num_scalars,
+			   cache_t *cache = nullptr) const
   {
 #ifdef HB_NO_VAR
     for (unsigned i = 0; i < num_scalars; i++)
@@ -3400,7 +3611,8 @@ struct ItemVariationStore
 
     (this+dataSets[major]).get_region_scalars (coords, coord_count,
 					       this+regions,
-					       &scalars[0], num_scalars);
+					       &scalars[0], num_scalars,
+					       cache);
   }
 
   unsigned int get_sub_table_count () const
@@ -733,6 +733,10 @@ struct hb_ot_apply_context_t :
   signed last_base = -1; // GPOS uses
   unsigned last_base_until = 0; // GPOS uses
 
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+  hb_array_t<const glyph_map_accelerator_t> glyph_maps; /* Of the subtable being applied. */
+#endif
+
   hb_ot_apply_context_t (unsigned int table_index_,
 			 hb_font_t *font_,
 			 hb_buffer_t *buffer_,
@@ -757,7 +761,7 @@ struct hb_ot_apply_context_t :
 			var_store (gdef.get_var_store ()),
 			var_store_cache (
 #ifndef HB_NO_VAR
-					 table_index == 1 && font->num_coords ? var_store.create_cache () : nullptr
+					 table_index == 1 ? var_store.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_GDEF) : nullptr
 #else
 					 nullptr
 #endif
@@ -770,7 +774,7 @@ struct hb_ot_apply_context_t :
   ~hb_ot_apply_context_t ()
   {
 #ifndef HB_NO_VAR
-    ItemVariationStore::destroy_cache (var_store_cache);
+    ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_GDEF, var_store_cache);
 #endif
   }
 
@@ -789,6 +793,27 @@ struct hb_ot_apply_context_t :
   void set_lookup_index (unsigned int lookup_index_) { lookup_index = lookup_index_; }
   void set_lookup_props (unsigned int lookup_props_) { lookup_props = lookup_props_; init_iters (); }
 
+  /* Same as coverage.get_coverage (glyph) and class_def.get_class (glyph),
+   * but use the glyph maps of the subtable being applied, if any. */
+  unsigned get_coverage (const Coverage &coverage, hb_codepoint_t glyph) const
+  {
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+    for (const auto &map : glyph_maps)
+      if (map.is_for (&coverage))
+	return map.get (glyph);
+#endif
+    return coverage.get_coverage (glyph);
+  }
+  unsigned get_class (const ClassDef &class_def, hb_codepoint_t glyph) const
+  {
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+    for (const auto &map : glyph_maps)
+      if (map.is_for (&class_def))
+	return map.get (glyph);
+#endif
+    return class_def.get_class (glyph);
+  }
+
   uint32_t random_number ()
   {
     /* http://www.cplusplus.com/reference/random/minstd_rand/ */
@@ -934,6 +959,13 @@ struct hb_accelerate_subtables_context_t :
   }
 #endif
 
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+  template <typename T>
+  static inline auto get_class_defs_ (const T &obj, const ClassDef **class_defs, hb_priority<1>) HB_RETURN (unsigned, obj.get_class_defs (class_defs) )
+  template <typename T>
+  static inline unsigned get_class_defs_ (const T &obj, const ClassDef **class_defs, hb_priority<0>) { return 0; }
+#endif
+
   typedef bool (*hb_apply_func_t) (const void *obj, hb_ot_apply_context_t *c);
   typedef bool (*hb_cache_func_t) (const void *obj, hb_ot_apply_context_t *c, bool enter);
 
@@ -959,16 +991,63 @@ struct hb_accelerate_subtables_context_t :
 #endif
       digest.init ();
       obj_.get_coverage ().collect_coverage (&digest);
+
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+      const ClassDef *class_defs[3] = {};
+      unsigned num_class_defs = get_class_defs_ (obj_, class_defs, hb_prioritize);
+      init_glyph_maps (obj_.get_coverage (), class_defs, num_class_defs);
+#endif
+    }
+
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+    void init_glyph_maps (const Coverage &coverage,
+			  const ClassDef * const *class_defs,
+			  unsigned num_class_defs)
+    {
+      glyph_map_accelerator_t maps[4] = {};
+      unsigned count = 0;
+      if (maps[count].init (coverage))
+	count++;
+      for (unsigned i = 0; i < num_class_defs; i++)
+      {
+	bool seen = false;
+	for (unsigned j = 0; j < count; j++)
+	  seen = seen || maps[j].is_for (class_defs[i]);
+	if (!seen && maps[count].init (*class_defs[i]))
+	  count++;
+      }
+      if (!count)
+	return;
+
+      glyph_maps = (glyph_map_accelerator_t *) hb_malloc (count * sizeof (glyph_maps[0]));
+      if (unlikely (!glyph_maps))
+      {
+	for (unsigned i = 0; i < count; i++)
+	  maps[i].fini ();
+	return;
+      }
+      hb_memcpy (glyph_maps, maps, count * sizeof (glyph_maps[0]));
+      num_glyph_maps = count;
+    }
+#endif
+
+    void fini ()
+    {
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+      for (unsigned i = 0; i < num_glyph_maps; i++)
+	glyph_maps[i].fini ();
+      hb_free (glyph_maps);
+#endif
     }
 
     bool apply (hb_ot_apply_context_t *c) const
     {
-      return digest.may_have (c->buffer->cur().codepoint) && apply_func (obj, c);
+      return digest.may_have (c->buffer->cur().codepoint) && apply_with (c, apply_func);
     }
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
     bool apply_cached (hb_ot_apply_context_t *c) const
     {
-      return digest.may_have (c->buffer->cur().codepoint) &&  apply_cached_func (obj, c);
+      return digest.may_have (c->buffer->cur().codepoint) && apply_with (c, apply_cached_func);
     }
     bool cache_enter (hb_ot_apply_context_t *c) const
     {
@@ -981,6 +1060,19 @@ struct hb_accelerate_subtables_context_t :
 #endif
 
     private:
+    bool apply_with (hb_ot_apply_context_t *c, hb_apply_func_t func) const
+    {
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+      auto saved_glyph_maps = c->glyph_maps;
+      c->glyph_maps = hb_array ((const glyph_map_accelerator_t *) glyph_maps, num_glyph_maps);
+      bool ret = func (obj, c);
+      c->glyph_maps = saved_glyph_maps;
+      return ret;
+#else
+      return func (obj, c);
+#endif
+    }
+
     const void *obj;
     hb_apply_func_t apply_func;
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
@@ -988,6 +1080,10 @@ struct hb_accelerate_subtables_context_t :
     hb_cache_func_t cache_func;
 #endif
     hb_set_digest_t digest;
+#ifndef HB_NO_OT_LAYOUT_GLYPH_MAP
+    glyph_map_accelerator_t *glyph_maps;
+    unsigned num_glyph_maps;
+#endif
   };
 
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
@@ -1045,6 +1141,62 @@ struct hb_accelerate_subtables_context_t :
 };
 
 
+#ifndef HB_NO_OT_LAYOUT_LOOKUP_DISPATCH
+/* Collects, for each glyph covered by a lookup, the list of its
+ * subtables that cover the glyph, in lookup order. */
+struct hb_collect_subtable_coverage_context_t :
+       hb_dispatch_context_t<hb_collect_subtable_coverage_context_t>
+{
+  template <typename T>
+  return_t dispatch (const T &obj)
+  {
+    unsigned subtable_index = i++;
+    if (unlikely (!successful))
+      return hb_empty_t ();
+
+    for (hb_codepoint_t g : obj.get_coverage ().iter ())
+    {
+      if (unlikely (++population > max_population))
+      {
+	successful = false;
+	break;
+      }
+      hb_vector_t<unsigned> *list;
+      if (!glyph_subtables.has (g, &list))
+      {
+	if (unlikely (!glyph_subtables.set (g, hb_vector_t<unsigned> ()) ||
+		      !glyph_subtables.has (g, &list)))
+	{
+	  successful = false;
+	  break;
+	}
+      }
+      /* Duplicate glyphs in a malformed Coverage. */
+      if (list->length && list->tail () == subtable_index)
+	continue;
+      list->push (subtable_index);
+      if (unlikely (list->in_error ()))
+      {
+	successful = false;
+	break;
+      }
+    }
+    return hb_empty_t ();
+  }
+  static return_t default_return_value () { return hb_empty_t (); }
+
+  hb_collect_subtable_coverage_context_t (unsigned max_population_) :
+					  max_population (max_population_) {}
+
+  hb_hashmap_t<hb_codepoint_t, hb_vector_t<unsigned>> glyph_subtables;
+  unsigned max_population;
+  unsigned population = 0;
+  unsigned i = 0;
+  bool successful = true;
+};
+#endif
+
+
 typedef bool (*intersects_func_t) (const hb_set_t *glyphs, unsigned value, const void *data, void *cache);
 typedef void (*intersected_glyphs_func_t) (const hb_set_t *glyphs, const void *data, unsigned value, hb_set_t *intersected_glyphs, void *cache);
 typedef void (*collect_glyphs_func_t) (hb_set_t *glyphs, unsigned value, const void *data);
@@ -2424,7 +2576,7 @@ struct ContextFormat1_4
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
-    unsigned int index = (this+coverage).get_coverage (c->buffer->cur().codepoint);
+    unsigned int index = c->get_coverage (this+coverage, c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED))
       return_trace (false);
 
@@ -2614,6 +2766,12 @@ struct ContextFormat2_5
 
   const Coverage &get_coverage () const { return this+coverage; }
 
+  unsigned get_class_defs (const ClassDef **class_defs) const
+  {
+    class_defs[0] = &(this+classDef);
+    return 1;
+  }
+
   unsigned cache_cost () const
   {
     unsigned c = (this+classDef).cost () * ruleSet.len;
@@ -2645,7 +2803,7 @@ struct ContextFormat2_5
   bool _apply (hb_ot_apply_context_t *c, bool cached) const
   {
     TRACE_APPLY (this);
-    unsigned int index = (this+coverage).get_coverage (c->buffer->cur().codepoint);
+    unsigned int index = c->get_coverage (this+coverage, c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
     const ClassDef &class_def = this+classDef;
@@ -2658,7 +2816,7 @@ struct ContextFormat2_5
     if (cached && c->buffer->cur().syllable() < 255)
       index = c->buffer->cur().syllable ();
     else
-      index = class_def.get_class (c->buffer->cur().codepoint);
+      index = c->get_class (class_def, c->buffer->cur().codepoint);
     const RuleSet &rule_set = this+ruleSet[index];
     return_trace (rule_set.apply (c, lookup_context));
   }
@@ -2831,7 +2989,7 @@ struct ContextFormat3
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
-    unsigned int index = (this+coverageZ[0]).get_coverage (c->buffer->cur().codepoint);
+    unsigned int index = c->get_coverage (this+coverageZ[0], c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
     const LookupRecord *lookupRecord = &StructAfter<LookupRecord> (coverageZ.as_array (glyphCount));
@@ -3645,7 +3803,7 @@ struct ChainContextFormat1_4
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
-    unsigned int index = (this+coverage).get_coverage (c->buffer->cur().codepoint);
+    unsigned int index = c->get_coverage (this+coverage, c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
     const ChainRuleSet &rule_set = this+ruleSet[index];
@@ -3855,6 +4013,12 @@ struct ChainContextFormat2_5
 
   const Coverage &get_coverage () const { return this+coverage; }
 
+  unsigned get_class_defs (const ClassDef **class_defs) const
+  {
+    class_defs[0] = &(this+inputClassDef);
+    return 1;
+  }
+
   unsigned cache_cost () const
   {
     unsigned c = (this+lookaheadClassDef).cost () * ruleSet.len;
@@ -3886,7 +4050,7 @@ struct ChainContextFormat2_5
   bool _apply (hb_ot_apply_context_t *c, bool cached) const
   {
     TRACE_APPLY (this);
-    unsigned int index = (this+coverage).get_coverage (c->buffer->cur().codepoint);
+    unsigned int index = c->get_coverage (this+coverage, c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
     const ClassDef &backtrack_class_def = this+backtrackClassDef;
@@ -3908,7 +4072,7 @@ struct ChainContextFormat2_5
     if (cached && ((c->buffer->cur().syllable() & 0xF0) >> 4) < 15)
       index = (c->buffer->cur().syllable () & 0xF0) >> 4;
     else
-      index = input_class_def.get_class (c->buffer->cur().codepoint);
+      index = c->get_class (input_class_def, c->buffer->cur().codepoint);
     const ChainRuleSet &rule_set = this+ruleSet[index];
     return_trace (rule_set.apply (c, lookup_context));
   }
@@ -4132,7 +4296,7 @@ struct ChainContextFormat3
     TRACE_APPLY (this);
     const auto &input = StructAfter<decltype (inputX)> (backtrack);
 
-    unsigned int index = (this+input[0]).get_coverage (c->buffer->cur().codepoint);
+    unsigned int index = c->get_coverage (this+input[0], c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
     const auto &lookahead = StructAfter<decltype (lookaheadX)> (input);
@@ -4376,6 +4540,13 @@ struct Extension
  * GSUB/GPOS Common
  */
 
+#ifndef HB_OT_LAYOUT_LOOKUP_DISPATCH_MIN_SUBTABLES
+#define HB_OT_LAYOUT_LOOKUP_DISPATCH_MIN_SUBTABLES 8
+#endif
+#ifndef HB_OT_LAYOUT_LOOKUP_DISPATCH_MAX_GLYPHS
+#define HB_OT_LAYOUT_LOOKUP_DISPATCH_MAX_GLYPHS 16384
+#endif
+
 struct hb_ot_layout_lookup_accelerator_t
 {
   template <typename TLookup>
@@ -4396,6 +4567,7 @@ struct hb_ot_layout_lookup_accelerator_t
     if (unlikely (!thiz))
       return nullptr;
 
+    thiz->subtable_count = count;
     hb_accelerate_subtables_context_t c_accelerate_subtables (thiz->subtables);
     lookup.dispatch (&c_accelerate_subtables);
 
@@ -4410,9 +4582,80 @@ struct hb_ot_layout_lookup_accelerator_t
 	thiz->subtables[i].apply_cached_func = thiz->subtables[i].apply_func;
 #endif
 
+#ifndef HB_NO_OT_LAYOUT_LOOKUP_DISPATCH
+    if (count >= HB_OT_LAYOUT_LOOKUP_DISPATCH_MIN_SUBTABLES)
+      thiz->init_dispatch (lookup);
+#endif
+
     return thiz;
   }
 
+  static void destroy (hb_ot_layout_lookup_accelerator_t *accel)
+  {
+    if (!accel) return;
+    for (unsigned i = 0; i < accel->subtable_count; i++)
+      accel->subtables[i].fini ();
+#ifndef HB_NO_OT_LAYOUT_LOOKUP_DISPATCH
+    hb_map_destroy (accel->dispatch_map);
+    hb_free (accel->dispatch_lists);
+#endif
+    hb_free (accel);
+  }
+
+#ifndef HB_NO_OT_LAYOUT_LOOKUP_DISPATCH
+  /* For lookups with many subtables, trying each subtable in turn on
+   * every glyph, each doing its own Coverage search, dominates.  Instead
+   * map each covered glyph to the list of subtables covering it, so that
+   * applying the lookup to a glyph takes one hash lookup and tries only
+   * the subtables that can apply.  The lists are stored in dispatch_lists
+   * as a count followed by subtable indices, and shared between glyphs. */
+  template <typename TLookup>
+  void init_dispatch (const TLookup &lookup)
+  {
+    hb_collect_subtable_coverage_context_t c (HB_OT_LAYOUT_LOOKUP_DISPATCH_MAX_GLYPHS);
+    lookup.dispatch (&c);
+    if (unlikely (!c.successful || c.glyph_subtables.in_error ()))
+      return;
+
+    hb_hashmap_t<hb_vector_t<unsigned>, unsigned> list_offsets;
+    hb_vector_t<unsigned> lists;
+    hb_map_t *map = hb_map_create ();
+    for (auto _ : c.glyph_subtables.iter_ref ())
+    {
+      const hb_vector_t<unsigned> &list = _.second;
+      unsigned *offset;
+      if (!list_offsets.has (list, &offset))
+      {
+	unsigned o = lists.length;
+	lists.push (list.length);
+	for (unsigned subtable_index : list)
+	  lists.push (subtable_index);
+	list_offsets.set (list, o);
+	if (unlikely (!list_offsets.has (list, &offset)))
+	  break;
+      }
+      map->set (_.first, *offset);
+    }
+
+    if (unlikely (lists.in_error () || list_offsets.in_error () || map->in_error ()))
+    {
+      hb_map_destroy (map);
+      return;
+    }
+
+    unsigned *dispatch_lists_;
+    if (unlikely (!(dispatch_lists_ = (unsigned *) hb_malloc (lists.get_size ()))))
+    {
+      hb_map_destroy (map);
+      return;
+    }
+    hb_memcpy (dispatch_lists_, lists.arrayZ, lists.get_size ());
+
+    dispatch_map = map;
+    dispatch_lists = dispatch_lists_;
+  }
+#endif
+
   bool may_have (hb_codepoint_t g) const
   { return digest.may_have (g); }
 
@@ -4421,6 +4664,27 @@ struct hb_ot_layout_lookup_accelerator_t
 #endif
   bool apply (hb_ot_apply_context_t *c, unsigned subtables_count, bool use_cache) const
   {
+#ifndef HB_NO_OT_LAYOUT_LOOKUP_DISPATCH
+    if (dispatch_map)
+    {
+      unsigned offset = dispatch_map->get (c->buffer->cur().codepoint);
+      if (offset == HB_MAP_VALUE_INVALID)
+	return false;
+      const unsigned *list = dispatch_lists + offset;
+      unsigned count = *list++;
+      for (unsigned i = 0; i < count; i++)
+      {
+	const auto &subtable = subtables[list[i]];
+#ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
+	if (use_cache ? subtable.apply_cached (c) : subtable.apply (c))
+#else
+	if (subtable.apply (c))
+#endif
+	  return true;
+      }
+      return false;
+    }
+#endif
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
     if (use_cache)
     {
@@ -4461,8 +4725,13 @@ struct hb_ot_layout_lookup_accelerator_t
 
   hb_set_digest_t digest;
   private:
+  unsigned subtable_count;
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
   unsigned cache_user_idx = (unsigned) -1;
+#endif
+#ifndef HB_NO_OT_LAYOUT_LOOKUP_DISPATCH
+  hb_map_t *dispatch_map = nullptr;
+  unsigned *dispatch_lists = nullptr;
 #endif
   hb_accelerate_subtables_context_t::hb_applicable_t subtables[HB_VAR_ARRAY];
 };
@@ -4507,7 +4776,9 @@ struct GSUBGPOSVersion1_2
     typedef List16OfOffsetTo<TLookup, typename Types::HBUINT> TLookupList;
     if (unlikely (!(scriptList.sanitize (c, this) &&
 		    featureList.sanitize (c, this) &&
-		    reinterpret_cast<const typename Types::template OffsetTo<TLookupList> &> (lookupList).sanitize (c, this))))
+		    (c->lazy_lookups
+		     ? sanitize_lookup_list_shallow (c)
+		     : reinterpret_cast<const typename Types::template OffsetTo<TLookupList> &> (lookupList).sanitize (c, this)))))
       return_trace (false);
 
 #ifndef HB_NO_VAR
@@ -4518,6 +4789,28 @@ struct GSUBGPOSVersion1_2
     return_trace (true);
   }
 
+  /* Checks the lookup list, but not the lookups it points to. */
+  bool sanitize_lookup_list_shallow (hb_sanitize_context_t *c) const
+  {
+    TRACE_SANITIZE (this);
+    return_trace (lookupList.sanitize_shallow (c, this) &&
+		  hb_barrier () &&
+		  (lookupList.is_null () ||
+		   (this+lookupList).sanitize_shallow (c) ||
+		   lookupList.neuter (c)));
+  }
+
+  template <typename TLookup>
+  bool sanitize_lookup (hb_sanitize_context_t *c, unsigned lookup_index) const
+  {
+    TRACE_SANITIZE (this);
+    typedef List16OfOffsetTo<TLookup, typename Types::HBUINT> TLookupList;
+    const TLookupList &list = reinterpret_cast<const TLookupList &> (this+lookupList);
+    if (unlikely (lookup_index >= list.len)) return_trace (false);
+    hb_barrier ();
+    return_trace (list.arrayZ[lookup_index].sanitize (c, &list));
+  }
+
   template <typename TLookup>
   bool subset (hb_subset_layout_context_t *c) const
   {
@@ -4597,6 +4890,20 @@ struct GSUBGPOS
     }
   }
 
+  /* Sanitizes one lookup of a table that was sanitized with lazy_lookups. */
+  template <typename TLookup>
+  bool sanitize_lookup (hb_sanitize_context_t *c, unsigned lookup_index) const
+  {
+    TRACE_SANITIZE (this);
+    switch (u.version.major) {
+    case 1: hb_barrier (); return_trace (u.version1.sanitize_lookup<TLookup> (c, lookup_index));
+#ifndef HB_NO_BEYOND_64K
+    case 2: hb_barrier (); return_trace (u.version2.sanitize_lookup<TLookup> (c, lookup_index));
+#endif
+    default: return_trace (false);
+    }
+  }
+
   template <typename TLookup>
   bool subset (hb_subset_layout_context_t *c) const
   {
@@ -4827,7 +5134,10 @@ struct GSUBGPOS
     {
       hb_sanitize_context_t sc;
       sc.lazy_some_gpos = true;
-      this->table = sc.reference_table<T> (face);
+      sc.set_num_glyphs (hb_face_get_glyph_count (face));
+      hb_blob_t *blob = hb_face_reference_table (face, T::tableTag);
+      sc.lazy_lookups = hb_blob_get_length (blob) >= HB_SANITIZE_LAZY_LOOKUPS_MIN_LENGTH;
+      this->table = sc.sanitize_blob<T> (blob);
 
       if (unlikely (this->table->is_blocklisted (this->table.get_blob (), face)))
       {
@@ -4837,8 +5147,27 @@ struct GSUBGPOS
 
       this->lookup_count = table->get_lookup_count ();
 
+      /* Each lookup is checked against a fixed budget, so that whether it
+       * passes does not depend on which lookups were checked before it.  A
+       * lookup needing more is taken from the copy of the table sanitized
+       * the usual way.  Lookups get an equal share of what is left of the
+       * sanitizer's ops; of its subtable budget too, unless the subtables
+       * of all lookups fit in it, as they do in any font eager sanitizing
+       * accepts. */
+      this->lazy = sc.lazy_lookups;
+      this->num_glyphs = sc.get_num_glyphs ();
+      unsigned shares = hb_max (1u, this->lookup_count);
+      int subtables_left = hb_max (HB_SANITIZE_MAX_SUBTABLES - sc.max_subtables, 0);
+      this->lookup_max_ops = hb_max (sc.max_ops, 0) / shares;
+      this->lookup_max_subtables = this->lazy && fits_subtables (subtables_left)
+				 ? subtables_left
+				 : subtables_left / shares;
+      this->lookup_checks = nullptr;
+
       this->accels = (hb_atomic_ptr_t<hb_ot_layout_lookup_accelerator_t> *) hb_calloc (this->lookup_count, sizeof (*accels));
-      if (unlikely (!this->accels))
+      if (this->lazy)
+	this->lookup_checks = (hb_atomic_int_t *) hb_calloc ((this->lookup_count + 15) / 16, sizeof (*lookup_checks));
+      if (unlikely (!this->accels || (this->lazy && !this->lookup_checks)))
       {
 	this->lookup_count = 0;
 	this->table.destroy ();
@@ -4848,13 +5177,28 @@ struct GSUBGPOS
     ~accelerator_t ()
     {
       for (unsigned int i = 0; i < this->lookup_count; i++)
-	hb_free (this->accels[i]);
+	hb_ot_layout_lookup_accelerator_t::destroy (this->accels[i]);
       hb_free (this->accels);
+      hb_free (this->lookup_checks);
+      hb_blob_destroy (this->sanitized_table.get_relaxed ());
       this->table.destroy ();
     }
 
     hb_blob_t *get_blob () const { return table.get_blob (); }
 
+    const typename T::Lookup &get_lookup (unsigned lookup_index) const
+    {
+      if (likely (!lazy)) return table->get_lookup (lookup_index);
+      if (unlikely (lookup_index >= lookup_count)) return Null (typename T::Lookup);
+
+      if (likely (check_lookup (lookup_index)))
+	return table->get_lookup (lookup_index);
+
+      /* The lookup needs edits to be usable; take it from a copy of the
+       * table sanitized the usual way, which makes them. */
+      return get_sanitized_table ().get_lookup (lookup_index);
+    }
+
     hb_ot_layout_lookup_accelerator_t *get_accel (unsigned lookup_index) const
     {
       if (unlikely (lookup_index >= lookup_count)) return nullptr;
@@ -4863,13 +5207,13 @@ struct GSUBGPOS
       auto *accel = accels[lookup_index].get_acquire ();
       if (unlikely (!accel))
       {
-	accel = hb_ot_layout_lookup_accelerator_t::create (table->get_lookup (lookup_index));
+	accel = hb_ot_layout_lookup_accelerator_t::create (get_lookup (lookup_index));
 	if (unlikely (!accel))
 	  return nullptr;
 
 	if (unlikely (!accels[lookup_index].cmpexch (nullptr, accel)))
 	{
-	  hb_free (accel);
+	  hb_ot_layout_lookup_accelerator_t::destroy (accel);
 	  goto retry;
 	}
       }
@@ -4877,9 +5221,84 @@ struct GSUBGPOS
       return accel;
     }
 
+    private:
+    /* Whether the subtable counts of all lookups add up to less than
+     * max_subtables. */
+    bool fits_subtables (int max_subtables) const
+    {
+      hb_sanitize_context_t sc (table.get_blob ());
+      int total = 0;
+      for (unsigned i = 0; i < lookup_count; i++)
+      {
+	const auto &lookup = table->get_lookup (i);
+	if (unlikely (!sc.check_range_fast (&lookup, Lookup::min_size)))
+	  return false;
+	hb_barrier ();
+	total += lookup.get_subtable_count ();
+	if (total >= max_subtables)
+	  return false;
+      }
+      return true;
+    }
+
+    /* Two bits per lookup in lookup_checks: checked, and passed. */
+    bool check_lookup (unsigned lookup_index) const
+    {
+      hb_atomic_int_t &word = lookup_checks[lookup_index / 16];
+      unsigned shift = 2 * (lookup_index % 16);
+      unsigned bits = (unsigned) word.get_acquire () >> shift;
+      if (likely (bits & 1))
+	return bits & 2;
+
+      hb_sanitize_context_t sc (table.get_blob ());
+      sc.set_num_glyphs (num_glyphs);
+      sc.lazy_some_gpos = true;
+      sc.set_max_ops (lookup_max_ops);
+      sc.max_subtables = HB_SANITIZE_MAX_SUBTABLES - lookup_max_subtables;
+      bool sane = table->template sanitize_lookup<typename T::Lookup> (&sc, lookup_index) &&
+		  !sc.get_edit_count ();
+
+      /* Not a compare-and-swap; an update lost to another thread only
+       * means that lookup gets checked again. */
+      word.set_release ((int) ((unsigned) word.get_relaxed () | ((sane ? 3u : 1u) << shift)));
+      return sane;
+    }
+
+    const T &get_sanitized_table () const
+    {
+    retry:
+      hb_blob_t *blob = sanitized_table.get_acquire ();
+      if (unlikely (!blob))
+      {
+	hb_sanitize_context_t sc;
+	sc.lazy_some_gpos = true;
+	sc.set_num_glyphs (num_glyphs);
+	/* A sub-blob, so that the edits go to a copy. */
+	blob = sc.sanitize_blob<T> (hb_blob_create_sub_blob (table.get_blob (), 0, (unsigned) -1));
+
+	if (unlikely (!sanitized_table.cmpexch (nullptr, blob)))
+	{
+	  hb_blob_destroy (blob);
+	  goto retry;
+	}
+      }
+
+      return *blob->as<T> ();
+    }
+
+    public:
     hb_blob_ptr_t<T> table;
     unsigned int lookup_count;
     hb_atomic_ptr_t<hb_ot_layout_lookup_accelerator_t> *accels;
+
+    private:
+    /* Lazily sanitized lookups; see check_lookup (). */
+    bool lazy;
+    unsigned num_glyphs;
+    hb_atomic_int_t *lookup_checks;
+    int lookup_max_ops;
+    int lookup_max_subtables;
+    mutable hb_atomic_ptr_t<hb_blob_t> sanitized_table;
   };
 
   protected:
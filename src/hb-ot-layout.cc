@@ -1401,13 +1401,13 @@ hb_ot_layout_lookup_collect_glyphs (hb_face_t    *face,
   {
     case HB_OT_TAG_GSUB:
     {
-      const OT::SubstLookup& l = face->table.GSUB->table->get_lookup (lookup_index);
+      const OT::SubstLookup& l = face->table.GSUB->get_lookup (lookup_index);
       l.collect_glyphs (&c);
       return;
     }
     case HB_OT_TAG_GPOS:
     {
-      const OT::PosLookup& l = face->table.GPOS->table->get_lookup (lookup_index);
+      const OT::PosLookup& l = face->table.GPOS->get_lookup (lookup_index);
       l.collect_glyphs (&c);
       return;
     }
@@ -1540,7 +1540,7 @@ hb_ot_layout_lookup_would_substitute (hb_face_t            *face,
   if (unlikely (lookup_index >= gsub->lookup_count)) return false;
   OT::hb_would_apply_context_t c (face, glyphs, glyphs_length, (bool) zero_context);
 
-  const OT::SubstLookup& l = gsub->table->get_lookup (lookup_index);
+  const OT::SubstLookup& l = gsub->get_lookup (lookup_index);
   auto *accel = gsub->get_accel (lookup_index);
   return accel && l.would_apply (&c, accel);
 }
@@ -1582,7 +1582,7 @@ hb_ot_layout_lookup_substitute_closure (hb_face_t    *face,
   hb_hashmap_t<unsigned, hb::unique_ptr<hb_set_t>> done_lookups_glyph_set;
   OT::hb_closure_context_t c (face, glyphs, &done_lookups_glyph_count, &done_lookups_glyph_set);
 
-  const OT::SubstLookup& l = face->table.GSUB->table->get_lookup (lookup_index);
+  const OT::SubstLookup& l = face->table.GSUB->get_lookup (lookup_index);
 
   l.closure (&c, lookup_index);
 }
@@ -1606,7 +1606,7 @@ hb_ot_layout_lookups_substitute_closure (hb_face_t      *face,
   hb_map_t done_lookups_glyph_count;
   hb_hashmap_t<unsigned, hb::unique_ptr<hb_set_t>> done_lookups_glyph_set;
   OT::hb_closure_context_t c (face, glyphs, &done_lookups_glyph_count, &done_lookups_glyph_set);
-  const GSUB& gsub = *face->table.GSUB->table;
+  const auto &gsub = *face->table.GSUB;
 
   unsigned int iteration_count = 0;
   unsigned int glyphs_length;
@@ -1621,7 +1621,7 @@ hb_ot_layout_lookups_substitute_closure (hb_face_t      *face,
     }
     else
     {
-      for (unsigned int i = 0; i < gsub.get_lookup_count (); i++)
+      for (unsigned int i = 0; i < gsub.lookup_count; i++)
 	gsub.get_lookup (i).closure (&c, i);
     }
   } while (iteration_count++ <= HB_CLOSURE_MAX_STAGES &&
@@ -1921,7 +1921,20 @@ apply_forward (OT::hb_ot_apply_context_t *c,
     if (applied)
       ret = true;
     else
-      (void) buffer->next_glyph ();
+    {
+      /* Find the next glyph the lookup may apply to, and move the run of
+       * glyphs before it to the output in one go, instead of one at a
+       * time; the lookup's glyphs are often sparse in the buffer. */
+      const hb_glyph_info_t *info = buffer->info;
+      unsigned count = buffer->len;
+      hb_mask_t lookup_mask = c->lookup_mask;
+      unsigned end = buffer->idx + 1;
+      while (end < count &&
+	     !((info[end].mask & lookup_mask) &&
+	       accel.digest.may_have (info[end].codepoint)))
+	end++;
+      (void) buffer->next_glyphs (end - buffer->idx);
+    }
   }
 
   if (use_cache)
@@ -2032,7 +2045,7 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
 	/* apply_string's set_lookup_props initializes the iterators. */
 
 	apply_string<Proxy> (&c,
-			     proxy.accel.table->get_lookup (lookup_index),
+			     proxy.accel.get_lookup (lookup_index),
 			     *accel);
       }
       else if (buffer->messaging ())
@@ -2627,7 +2640,7 @@ hb_ot_layout_lookup_get_glyph_alternates (hb_face_t      *face,
 					  hb_codepoint_t *alternate_glyphs /* OUT.     May be NULL. */)
 {
   hb_get_glyph_alternates_dispatch_t c;
-  const OT::SubstLookup &lookup = face->table.GSUB->table->get_lookup (lookup_index);
+  const OT::SubstLookup &lookup = face->table.GSUB->get_lookup (lookup_index);
   auto ret = lookup.dispatch (&c, glyph, start_offset, alternate_count, alternate_glyphs);
   if (!ret && alternate_count) *alternate_count = 0;
   return ret;
@@ -2673,7 +2686,7 @@ hb_ot_layout_lookup_get_optical_bound (hb_font_t      *font,
 				       hb_direction_t  direction,
 				       hb_codepoint_t  glyph)
 {
-  const OT::PosLookup &lookup = font->face->table.GPOS->table->get_lookup (lookup_index);
+  const OT::PosLookup &lookup = font->face->table.GPOS->get_lookup (lookup_index);
   hb_blob_t *blob = font->face->table.GPOS->get_blob ();
   hb_glyph_position_t pos = {0};
   hb_position_single_dispatch_t c;
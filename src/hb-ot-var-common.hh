@@ -926,6 +926,9 @@ struct TupleVariationData
                                      const hb_array_t<const F2DOT14> shared_tuples,
                                      bool is_composite_glyph)
     {
+      /* point set of the tuples using the shared point numbers, built on
+       * first use and then copied for each of them */
+      hb_vector_t<bool> shared_points_set;
       do
       {
         const HBUINT8 *p = iterator.get_serialized_data ();
@@ -965,18 +968,34 @@ struct TupleVariationData
 
         tuple_delta_t var;
         var.axis_tuples = std::move (axis_tuples);
-        if (unlikely (!var.indices.resize (point_count) ||
-                      !var.deltas_x.resize (point_count, false)))
+        if (unlikely (!var.deltas_x.resize (point_count, false)))
           return false;
 
         if (is_gvar && unlikely (!var.deltas_y.resize (point_count, false)))
           return false;
 
+        if (!has_private_points && shared_points_set)
+          var.indices = shared_points_set;
+        else
+        {
+          if (unlikely (!var.indices.resize (point_count)))
+            return false;
+          for (unsigned i = 0; i < num_deltas; i++)
+          {
+            unsigned idx = apply_to_all ? i : indices[i];
+            if (idx < point_count)
+              var.indices.arrayZ[idx] = true;
+          }
+          if (!has_private_points)
+            shared_points_set = var.indices;
+        }
+        if (unlikely (var.indices.in_error ()))
+          return false;
+
         for (unsigned i = 0; i < num_deltas; i++)
         {
           unsigned idx = apply_to_all ? i : indices[i];
           if (idx >= point_count) continue;
-          var.indices[idx] = true;
           var.deltas_x[idx] = deltas_x[i];
           if (is_gvar)
             var.deltas_y[idx] = deltas_y[i];
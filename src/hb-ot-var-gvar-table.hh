@@ -72,82 +72,82 @@ struct glyph_variations_t
                                     const hb_subset_plan_t *plan,
                                     const hb_hashmap_t<hb_codepoint_t, hb_bytes_t>& new_gid_var_data_map)
   {
-    if (unlikely (!glyph_variations.alloc (plan->new_to_old_gid_list.length, true)))
+    /* the vector is kept in sync with the new_to_old_gid_list, glyphs
+     * without variation data get an empty entry */
+    if (unlikely (!glyph_variations.resize_exact (plan->new_to_old_gid_list.length)))
       return false;
 
-    auto it = hb_iter (plan->new_to_old_gid_list);
-    for (auto &_ : it)
+    return for_each_glyph (plan, [&] (unsigned i)
     {
-      hb_codepoint_t new_gid = _.first;
+      hb_codepoint_t new_gid = plan->new_to_old_gid_list[i].first;
       contour_point_vector_t *all_contour_points;
-      if (!new_gid_var_data_map.has (new_gid) ||
+      const hb_bytes_t *var_data_p;
+      if (!new_gid_var_data_map.has (new_gid, &var_data_p) ||
           !plan->new_gid_contour_points_map.has (new_gid, &all_contour_points))
         return false;
-      hb_bytes_t var_data = new_gid_var_data_map.get (new_gid);
+      hb_bytes_t var_data = *var_data_p;
 
       const GlyphVariationData* p = reinterpret_cast<const GlyphVariationData*> (var_data.arrayZ);
       hb_vector_t<unsigned> shared_indices;
       GlyphVariationData::tuple_iterator_t iterator;
-      tuple_variations_t tuple_vars;
 
-      /* in case variation data is empty, push an empty struct into the vector,
-       * keep the vector in sync with the new_to_old_gid_list */
       if (!var_data || ! p->has_data () || !all_contour_points->length ||
           !GlyphVariationData::get_tuple_iterator (var_data, axis_count,
                                                    var_data.arrayZ,
                                                    shared_indices, &iterator))
-      {
-        glyph_variations.push (std::move (tuple_vars));
-        continue;
-      }
+        return true;
 
       bool is_composite_glyph = false;
       is_composite_glyph = plan->composite_new_gids.has (new_gid);
 
-      if (!p->decompile_tuple_variations (all_contour_points->length, true /* is_gvar */,
-                                          iterator, &(plan->axes_old_index_tag_map),
-                                          shared_indices, shared_tuples,
-                                          tuple_vars, /* OUT */
-                                          is_composite_glyph))
-        return false;
-      glyph_variations.push (std::move (tuple_vars));
-    }
-    return !glyph_variations.in_error () && glyph_variations.length == plan->new_to_old_gid_list.length;
+      return p->decompile_tuple_variations (all_contour_points->length, true /* is_gvar */,
+                                            iterator, &(plan->axes_old_index_tag_map),
+                                            shared_indices, shared_tuples,
+                                            glyph_variations[i], /* OUT */
+                                            is_composite_glyph);
+    });
   }
 
   bool instantiate (const hb_subset_plan_t *plan)
   {
-    unsigned count = plan->new_to_old_gid_list.length;
     bool iup_optimize = false;
     iup_optimize = plan->flags & HB_SUBSET_FLAGS_OPTIMIZE_IUP_DELTAS;
-    for (unsigned i = 0; i < count; i++)
+    return for_each_glyph (plan, [&] (unsigned i)
     {
       hb_codepoint_t new_gid = plan->new_to_old_gid_list[i].first;
       contour_point_vector_t *all_points;
       if (!plan->new_gid_contour_points_map.has (new_gid, &all_points))
         return false;
-      if (!glyph_variations[i].instantiate (plan->axes_location, plan->axes_triple_distances, all_points, iup_optimize))
-        return false;
-    }
-    return true;
+      return glyph_variations[i].instantiate (plan->axes_location, plan->axes_triple_distances, all_points, iup_optimize);
+    });
   }
 
-  bool compile_bytes (const hb_map_t& axes_index_map,
-                      const hb_map_t& axes_old_index_tag_map)
+  bool compile_bytes (const hb_subset_plan_t *plan)
   {
-    if (!compile_shared_tuples (axes_index_map, axes_old_index_tag_map))
+    const hb_map_t& axes_index_map = plan->axes_index_map;
+    const hb_map_t& axes_old_index_tag_map = plan->axes_old_index_tag_map;
+    if (!for_each_glyph (plan, [&] (unsigned i)
+        {
+          for (tuple_delta_t& var : glyph_variations[i].tuple_vars)
+            if (!var.compile_peak_coords (axes_index_map, axes_old_index_tag_map))
+              return false;
+          return true;
+        }))
       return false;
-    for (tuple_variations_t& vars: glyph_variations)
-      if (!vars.compile_bytes (axes_index_map, axes_old_index_tag_map,
-                               true, /* use shared points*/
-                               &shared_tuples_idx_map))
-        return false;
 
-    return true;
+    if (!compile_shared_tuples ())
+      return false;
+
+    return for_each_glyph (plan, [&] (unsigned i)
+    {
+      return glyph_variations[i].compile_bytes (axes_index_map, axes_old_index_tag_map,
+                                                true, /* use shared points*/
+                                                &shared_tuples_idx_map);
+    });
   }
 
-  bool compile_shared_tuples (const hb_map_t& axes_index_map,
-                              const hb_map_t& axes_old_index_tag_map)
+  /* peak coords of all the tuples must have been compiled already */
+  bool compile_shared_tuples ()
   {
     /* key is pointer to compiled_peak_coords inside each tuple, hashing
      * function will always deref pointers first */
@@ -158,8 +158,6 @@ struct glyph_variations_t
     {
       for (tuple_delta_t& var : vars.tuple_vars)
       {
-        if (!var.compile_peak_coords (axes_index_map, axes_old_index_tag_map))
-          return false;
         unsigned* count;
         if (coords_count_map.has (&(var.compiled_peak_coords), &count))
           coords_count_map.set (&(var.compiled_peak_coords), *count + 1);
@@ -206,6 +204,44 @@ struct glyph_variations_t
     return true;
   }
 
+  /* Glyphs are processed in ranges of this many, concurrently with
+   * HB_SUBSET_FLAGS_PARALLEL. */
+  static constexpr unsigned glyphs_per_task = 256;
+
+  /* Calls func (i) for the index of each glyph in the subset.  Returns false
+   * if any of the calls did. */
+  template <typename Func>
+  bool for_each_glyph (const hb_subset_plan_t *plan, Func&& func) const
+  {
+    struct task_data_t
+    {
+      Func *func;
+      unsigned count;
+      hb_atomic_int_t failed;
+    } data;
+    data.func = &func;
+    data.count = glyph_variations.length;
+    data.failed = 0;
+
+    unsigned num_tasks = (data.count + glyphs_per_task - 1) / glyphs_per_task;
+    plan->run_tasks (num_tasks, [] (unsigned index, void *task_data)
+    {
+      auto *task = (task_data_t *) task_data;
+      unsigned end = hb_min (task->count, (index + 1) * glyphs_per_task);
+      for (unsigned i = index * glyphs_per_task; i < end; i++)
+      {
+        if (task->failed) return;
+        if (!(*task->func) (i))
+        {
+          task->failed = 1;
+          return;
+        }
+      }
+    }, &data);
+
+    return !data.failed;
+  }
+
   static int _cmp_coords (const void *pa, const void *pb, void *arg)
   {
     const hb_hashmap_t<const hb_vector_t<char>*, unsigned>* coords_count_map =
@@ -397,8 +433,7 @@ struct gvar
       return_trace (false);
 
     if (!glyph_vars.instantiate (c->plan)) return_trace (false);
-    if (!glyph_vars.compile_bytes (c->plan->axes_index_map, c->plan->axes_old_index_tag_map))
-      return_trace (false);
+    if (!glyph_vars.compile_bytes (c->plan)) return_trace (false);
 
     unsigned axis_count = c->plan->axes_index_map.get_population ();
     unsigned num_glyphs = c->plan->num_output_glyphs ();
@@ -596,27 +631,69 @@ struct gvar
 
     private:
 
-    static float infer_delta (const hb_array_t<contour_point_t> points,
-			      const hb_array_t<contour_point_t> deltas,
-			      unsigned int target, unsigned int prev, unsigned int next,
-			      float contour_point_t::*m)
+    /* Compiler-assisted vectorization.  The delta kernels work on separate
+     * x and y arrays, in blocks of a fixed number of elements and with
+     * branches turned into selects, so that compilers can vectorize them
+     * for the SIMD of the target.  The rest is done one element at a time. */
+    static constexpr unsigned kernel_block_size = 8;
+
+    static void add_deltas (float *out, const int *deltas, unsigned count, float scalar)
     {
-      float target_val = points.arrayZ[target].*m;
-      float prev_val = points.arrayZ[prev].*m;
-      float next_val = points.arrayZ[next].*m;
-      float prev_delta =  deltas.arrayZ[prev].*m;
-      float next_delta =  deltas.arrayZ[next].*m;
+      if (!HB_OPTIMIZE_SIZE_VAL)
+	for (; count >= kernel_block_size; count -= kernel_block_size)
+	{
+	  for (unsigned j = 0; j < kernel_block_size; j++)
+	    out[j] += deltas[j] * scalar;
+	  out += kernel_block_size;
+	  deltas += kernel_block_size;
+	}
+      for (unsigned i = 0; i < count; i++)
+	out[i] += deltas[i] * scalar;
+    }
 
+    /* Infers the deltas of the unreferenced points start..end-1 from the
+     * referenced points prev and next around them. */
+    static void infer_deltas (float *out, const float *orig,
+			      unsigned start, unsigned end,
+			      float prev_val, float next_val,
+			      float prev_delta, float next_delta)
+    {
       if (prev_val == next_val)
-	return (prev_delta == next_delta) ? prev_delta : 0.f;
-      else if (target_val <= hb_min (prev_val, next_val))
-	return (prev_val < next_val) ? prev_delta : next_delta;
-      else if (target_val >= hb_max (prev_val, next_val))
-	return (prev_val > next_val) ? prev_delta : next_delta;
-
-      /* linear interpolation */
-      float r = (target_val - prev_val) / (next_val - prev_val);
-      return prev_delta + r * (next_delta - prev_delta);
+      {
+	float delta = (prev_delta == next_delta) ? prev_delta : 0.f;
+	for (unsigned i = start; i < end; i++)
+	  out[i] = delta;
+	return;
+      }
+
+      float min_val = hb_min (prev_val, next_val);
+      float max_val = hb_max (prev_val, next_val);
+      float min_delta = (prev_val < next_val) ? prev_delta : next_delta;
+      float max_delta = (prev_val > next_val) ? prev_delta : next_delta;
+      float val_range = next_val - prev_val;
+      float delta_range = next_delta - prev_delta;
+      auto infer = [&] (float target_val)
+      {
+	/* linear interpolation */
+	float r = (target_val - prev_val) / val_range;
+	float delta = prev_delta + r * delta_range;
+	delta = target_val >= max_val ? max_delta : delta;
+	return target_val <= min_val ? min_delta : delta;
+      };
+
+      out += start;
+      orig += start;
+      unsigned count = end - start;
+      if (!HB_OPTIMIZE_SIZE_VAL)
+	for (; count >= kernel_block_size; count -= kernel_block_size)
+	{
+	  for (unsigned j = 0; j < kernel_block_size; j++)
+	    out[j] = infer (orig[j]);
+	  out += kernel_block_size;
+	  orig += kernel_block_size;
+	}
+      for (unsigned i = 0; i < count; i++)
+	out[i] = infer (orig[i]);
     }
 
     static unsigned int next_index (unsigned int i, unsigned int start, unsigned int end)
@@ -639,13 +716,14 @@ struct gvar
 						   shared_indices, &iterator))
 	return true; /* so isn't applied at all */
 
-      /* Save original points for inferred delta calculation */
-      contour_point_vector_t orig_points_vec; // Populated lazily
-      auto orig_points = orig_points_vec.as_array ();
+      /* Accumulated deltas, followed by the original points saved for
+       * inferred delta calculation; all as separate x and y arrays. */
+      hb_vector_t<float> scratch; // Populated lazily
+      float *deltas_x = nullptr, *deltas_y = nullptr;
+      float *orig_x = nullptr, *orig_y = nullptr;
 
-      /* flag is used to indicate referenced point */
-      contour_point_vector_t deltas_vec; // Populated lazily
-      auto deltas = deltas_vec.as_array ();
+      /* referenced is set for points with explicit deltas specified */
+      hb_vector_t<bool> referenced;
 
       hb_vector_t<unsigned> end_points; // Populated lazily
 
@@ -656,6 +734,21 @@ struct gvar
       hb_vector_t<int> x_deltas;
       hb_vector_t<int> y_deltas;
       unsigned count = points.length;
+      unsigned first = phantom_only ? count - 4 : 0;
+      auto clear_deltas = [&] ()
+      {
+	hb_memset (deltas_x + first, 0, (count - first) * sizeof (deltas_x[0]));
+	hb_memset (deltas_y + first, 0, (count - first) * sizeof (deltas_y[0]));
+	hb_memset (referenced.arrayZ + first, 0, (count - first) * sizeof (referenced[0]));
+      };
+      auto flush_deltas = [&] ()
+      {
+	for (unsigned int i = first; i < count; i++)
+	{
+	  points.arrayZ[i].x += deltas_x[i];
+	  points.arrayZ[i].y += deltas_y[i];
+	}
+      };
       bool flush = false;
       do
       {
@@ -667,12 +760,13 @@ struct gvar
 	if (unlikely (!iterator.var_data_bytes.check_range (p, length)))
 	  return false;
 
-	if (!deltas)
+	if (!deltas_x)
 	{
-	  if (unlikely (!deltas_vec.resize (count, false))) return false;
-	  deltas = deltas_vec.as_array ();
-	  hb_memset (deltas.arrayZ + (phantom_only ? count - 4 : 0), 0,
-		     (phantom_only ? 4 : count) * sizeof (deltas[0]));
+	  if (unlikely (!scratch.resize (count * (phantom_only ? 2 : 4), false) ||
+			!referenced.resize (count, false))) return false;
+	  deltas_x = scratch.arrayZ;
+	  deltas_y = deltas_x + count;
+	  clear_deltas ();
 	}
 
 	const HBUINT8 *end = p + length;
@@ -692,91 +786,40 @@ struct gvar
 
 	if (!apply_to_all)
 	{
-	  if (!orig_points && !phantom_only)
+	  if (!orig_x && !phantom_only)
 	  {
-	    orig_points_vec.extend (points);
-	    if (unlikely (orig_points_vec.in_error ())) return false;
-	    orig_points = orig_points_vec.as_array ();
+	    orig_x = deltas_y + count;
+	    orig_y = orig_x + count;
+	    for (unsigned i = 0; i < count; i++)
+	    {
+	      orig_x[i] = points.arrayZ[i].x;
+	      orig_y[i] = points.arrayZ[i].y;
+	    }
 	  }
 
 	  if (flush)
 	  {
-	    for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	      points.arrayZ[i].translate (deltas.arrayZ[i]);
+	    flush_deltas ();
 	    flush = false;
-
 	  }
-	  hb_memset (deltas.arrayZ + (phantom_only ? count - 4 : 0), 0,
-		     (phantom_only ? 4 : count) * sizeof (deltas[0]));
+	  clear_deltas ();
 	}
 
-	if (HB_OPTIMIZE_SIZE_VAL)
+	if (apply_to_all)
 	{
-	  for (unsigned int i = 0; i < num_deltas; i++)
-	  {
-	    unsigned int pt_index;
-	    if (apply_to_all)
-	      pt_index = i;
-	    else
-	    {
-	      pt_index = indices[i];
-	      if (unlikely (pt_index >= deltas.length)) continue;
-	    }
-	    if (phantom_only && pt_index < count - 4) continue;
-	    auto &delta = deltas.arrayZ[pt_index];
-	    delta.flag = 1;	/* this point is referenced, i.e., explicit deltas specified */
-	    delta.x += x_deltas.arrayZ[i] * scalar;
-	    delta.y += y_deltas.arrayZ[i] * scalar;
-	  }
+	  add_deltas (deltas_x + first, x_deltas.arrayZ + first, count - first, scalar);
+	  add_deltas (deltas_y + first, y_deltas.arrayZ + first, count - first, scalar);
 	}
 	else
-	{
-	  /* Ouch. Four cases... for optimization. */
-	  if (scalar != 1.0f)
-	  {
-	    if (apply_to_all)
-	      for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	      {
-		unsigned int pt_index = i;
-		auto &delta = deltas.arrayZ[pt_index];
-		delta.x += x_deltas.arrayZ[i] * scalar;
-		delta.y += y_deltas.arrayZ[i] * scalar;
-	      }
-	    else
-	      for (unsigned int i = 0; i < num_deltas; i++)
-	      {
-		unsigned int pt_index = indices[i];
-		if (unlikely (pt_index >= deltas.length)) continue;
-		if (phantom_only && pt_index < count - 4) continue;
-		auto &delta = deltas.arrayZ[pt_index];
-		delta.flag = 1;	/* this point is referenced, i.e., explicit deltas specified */
-		delta.x += x_deltas.arrayZ[i] * scalar;
-		delta.y += y_deltas.arrayZ[i] * scalar;
-	      }
-	  }
-	  else
+	  for (unsigned int i = 0; i < num_deltas; i++)
 	  {
-	    if (apply_to_all)
-	      for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	      {
-		unsigned int pt_index = i;
-		auto &delta = deltas.arrayZ[pt_index];
-		delta.x += x_deltas.arrayZ[i];
-		delta.y += y_deltas.arrayZ[i];
-	      }
-	    else
-	      for (unsigned int i = 0; i < num_deltas; i++)
-	      {
-		unsigned int pt_index = indices[i];
-		if (unlikely (pt_index >= deltas.length)) continue;
-		if (phantom_only && pt_index < count - 4) continue;
-		auto &delta = deltas.arrayZ[pt_index];
-		delta.flag = 1;	/* this point is referenced, i.e., explicit deltas specified */
-		delta.x += x_deltas.arrayZ[i];
-		delta.y += y_deltas.arrayZ[i];
-	      }
+	    unsigned int pt_index = indices.arrayZ[i];
+	    if (unlikely (pt_index >= count)) continue;
+	    if (phantom_only && pt_index < first) continue;
+	    referenced.arrayZ[pt_index] = true;
+	    deltas_x[pt_index] += x_deltas.arrayZ[i] * scalar;
+	    deltas_y[pt_index] += y_deltas.arrayZ[i] * scalar;
 	  }
-	}
 
 	/* infer deltas for unreferenced points */
 	if (!apply_to_all && !phantom_only)
@@ -795,7 +838,7 @@ struct gvar
 	    /* Check the number of unreferenced points in a contour. If no unref points or no ref points, nothing to do. */
 	    unsigned unref_count = 0;
 	    for (unsigned i = start_point; i < end_point + 1; i++)
-	      unref_count += deltas.arrayZ[i].flag;
+	      unref_count += referenced.arrayZ[i];
 	    unref_count = (end_point - start_point + 1) - unref_count;
 
 	    unsigned j = start_point;
@@ -812,26 +855,37 @@ struct gvar
 	      {
 		i = j;
 		j = next_index (i, start_point, end_point);
-		if (deltas.arrayZ[i].flag && !deltas.arrayZ[j].flag) break;
+		if (referenced.arrayZ[i] && !referenced.arrayZ[j]) break;
 	      }
 	      prev = j = i;
 	      for (;;)
 	      {
 		i = j;
 		j = next_index (i, start_point, end_point);
-		if (!deltas.arrayZ[i].flag && deltas.arrayZ[j].flag) break;
+		if (!referenced.arrayZ[i] && referenced.arrayZ[j]) break;
 	      }
 	      next = j;
+
 	      /* Infer deltas for all unref points in the gap between prev and next */
-	      i = prev;
-	      for (;;)
+	      auto infer_run = [&] (unsigned run_start, unsigned run_end)
+	      {
+		infer_deltas (deltas_x, orig_x, run_start, run_end,
+			      orig_x[prev], orig_x[next],
+			      deltas_x[prev], deltas_x[next]);
+		infer_deltas (deltas_y, orig_y, run_start, run_end,
+			      orig_y[prev], orig_y[next],
+			      deltas_y[prev], deltas_y[next]);
+		unref_count -= run_end - run_start;
+	      };
+	      if (prev < next)
+		infer_run (prev + 1, next);
+	      else
 	      {
-		i = next_index (i, start_point, end_point);
-		if (i == next) break;
-		deltas.arrayZ[i].x = infer_delta (orig_points, deltas, i, prev, next, &contour_point_t::x);
-		deltas.arrayZ[i].y = infer_delta (orig_points, deltas, i, prev, next, &contour_point_t::y);
-		if (--unref_count == 0) goto no_more_gaps;
+		/* The gap wraps around end_point. */
+		infer_run (prev + 1, end_point + 1);
+		infer_run (start_point, next);
 	      }
+	      if (unref_count == 0) goto no_more_gaps;
 	    }
 	  no_more_gaps:
 	    start_point = end_point + 1;
@@ -843,10 +897,7 @@ struct gvar
       } while (iterator.move_to_next ());
 
       if (flush)
-      {
-	for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	  points.arrayZ[i].translate (deltas.arrayZ[i]);
-      }
+	flush_deltas ();
 
       return true;
     }
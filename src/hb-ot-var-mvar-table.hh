@@ -130,7 +130,8 @@ struct MVAR
   }
 
   float get_var (hb_tag_t tag,
-		 const int *coords, unsigned int coord_count) const
+		 const int *coords, unsigned int coord_count,
+		 VarRegionList::cache_t *cache = nullptr) const
   {
     const VariationValueRecord *record;
     record = (VariationValueRecord *) hb_bsearch (tag,
@@ -141,7 +142,19 @@ struct MVAR
     if (!record)
       return 0.;
 
-    return (this+varStore).get_delta (record->varIdx, coords, coord_count);
+    return (this+varStore).get_delta (record->varIdx, coords, coord_count, cache);
+  }
+
+  /* Same, at the coords of @font, using its region scalar cache. */
+  float get_var (hb_tag_t tag, hb_font_t *font) const
+  {
+    if (!font->num_coords) return 0.;
+
+    const ItemVariationStore &var_store = this+varStore;
+    auto *cache = var_store.acquire_cache (font, hb_font_t::VAR_STORE_CACHE_MVAR);
+    float v = get_var (tag, font->coords, font->num_coords, cache);
+    ItemVariationStore::release_cache (font, hb_font_t::VAR_STORE_CACHE_MVAR, cache);
+    return v;
   }
 
 protected:
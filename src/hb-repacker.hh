@@ -402,7 +402,9 @@ hb_resolve_graph_overflows (hb_tag_t table_tag,
       }
     }
 
-    sorted_graph.sort_shortest_distance ();
+    // Only the resolution steps above changed the graph, so most of the
+    // previous ordering can usually be kept.
+    sorted_graph.sort_shortest_distance_incremental ();
   }
 
   if (sorted_graph.in_error ())
@@ -98,6 +98,11 @@
  * structure is so complicated that by checking all offsets at sanitize() time,
  * we make the code much simpler in other methods, as offsets and referenced
  * objects do not need to be validated at each use site.
+ *
+ * Large GSUB/GPOS tables meet halfway: with lazy_lookups set, only the
+ * lookup list itself is checked at load time, and the layout accelerator
+ * sanitizes each lookup the first time it is used.  The rest of the code
+ * still sees fully sanitized lookups.
  */
 
 /* This limits sanitizing time on really broken fonts. */
@@ -116,6 +121,11 @@
 #ifndef HB_SANITIZE_MAX_SUBTABLES
 #define HB_SANITIZE_MAX_SUBTABLES 0x4000
 #endif
+/* GSUB/GPOS tables at least this long get their lookups sanitized on
+ * first use instead of upfront. */
+#ifndef HB_SANITIZE_LAZY_LOOKUPS_MIN_LENGTH
+#define HB_SANITIZE_LAZY_LOOKUPS_MIN_LENGTH 65536
+#endif
 
 struct hb_sanitize_context_t :
        hb_dispatch_context_t<hb_sanitize_context_t, bool, HB_DEBUG_SANITIZE>
@@ -129,7 +139,8 @@ struct hb_sanitize_context_t :
 	blob (nullptr),
 	num_glyphs (65536),
 	num_glyphs_set (false),
-	lazy_some_gpos (false) {}
+	lazy_some_gpos (false),
+	lazy_lookups (false) {}
 
   const char *get_name () { return "SANITIZE"; }
   template <typename T, typename F>
@@ -512,6 +523,7 @@ struct hb_sanitize_context_t :
   bool  num_glyphs_set;
   public:
   bool lazy_some_gpos;
+  bool lazy_lookups;
 };
 
 struct hb_sanitize_with_object_t
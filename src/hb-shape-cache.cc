@@ -0,0 +1,290 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+
+#ifndef HB_NO_SHAPER
+
+#include "hb-shape-cache.hh"
+
+
+/**
+ * SECTION:hb-shape-cache
+ * @title: hb-shape-cache
+ * @short_description: Caching of shaping results for short runs
+ * @include: hb.h
+ *
+ * A shape cache memoizes the output of shaping short runs of text, such
+ * as words, so that shaping a run that has been seen before turns into a
+ * hash lookup and a copy of the glyph infos and positions.
+ *
+ * Results are keyed on the shape plan, the font and its serial numbers,
+ * the buffer settings and random state, the user features, the buffer
+ * context, and the text of the run.  Any change to the font (for example,
+ * setting its scale or variation coordinates) therefore naturally misses
+ * the cache.  A cached result also restores the random state that shaping
+ * the run left in the buffer, so the `rand` feature keeps picking
+ * alternates as it would without the cache.
+ *
+ * Shape caches are thread-safe and bounded; once full, the
+ * least-recently-used result is evicted.
+ **/
+
+
+/**
+ * hb_shape_cache_create:
+ * @max_entries: Maximum number of shaping results to hold, or zero
+ *    for the default
+ *
+ * Creates a new, empty shape cache holding up to @max_entries results.
+ *
+ * Return value: (transfer full): The new #hb_shape_cache_t
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_create (unsigned int max_entries)
+{
+  if (!max_entries)
+    max_entries = HB_SHAPE_CACHE_DEFAULT_MAX_ENTRIES;
+
+  hb_shape_cache_t *cache;
+
+  if (!(cache = hb_object_create<hb_shape_cache_t> (max_entries)))
+    return hb_shape_cache_get_empty ();
+
+  return cache;
+}
+
+/**
+ * hb_shape_cache_get_empty:
+ *
+ * Fetches the singleton empty shape cache.  Shaping with the empty
+ * shape cache never caches anything.
+ *
+ * Return value: (transfer full): The empty #hb_shape_cache_t
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_get_empty ()
+{
+  return const_cast<hb_shape_cache_t *> (&Null (hb_shape_cache_t));
+}
+
+/**
+ * hb_shape_cache_reference: (skip)
+ * @cache: A shape cache
+ *
+ * Increases the reference count on a shape cache.
+ *
+ * Return value: (transfer full): The shape cache
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache)
+{
+  return hb_object_reference (cache);
+}
+
+/**
+ * hb_shape_cache_destroy: (skip)
+ * @cache: A shape cache
+ *
+ * Decreases the reference count on a shape cache. When
+ * the reference count reaches zero, the shape cache is
+ * destroyed, releasing all cached results.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_cache_destroy (hb_shape_cache_t *cache)
+{
+  if (!hb_object_destroy (cache)) return;
+
+  hb_free (cache);
+}
+
+/**
+ * hb_shape_cache_set_user_data: (skip)
+ * @cache: A shape cache
+ * @key: The user-data key to set
+ * @data: A pointer to the user data to set
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified shape cache.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace)
+{
+  return hb_object_set_user_data (cache, key, data, destroy, replace);
+}
+
+/**
+ * hb_shape_cache_get_user_data: (skip)
+ * @cache: A shape cache
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified shape cache.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * XSince: REPLACEME
+ **/
+void *
+hb_shape_cache_get_user_data (const hb_shape_cache_t *cache,
+			      hb_user_data_key_t     *key)
+{
+  return hb_object_get_user_data (cache, key);
+}
+
+/**
+ * hb_shape_cache_clear:
+ * @cache: A shape cache
+ *
+ * Drops all cached results from @cache, releasing the fonts and
+ * shape plans they reference.  Statistics are not reset.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_cache_clear (hb_shape_cache_t *cache)
+{
+  if (unlikely (hb_object_is_immutable (cache)))
+    return;
+
+  cache->clear ();
+}
+
+/**
+ * hb_shape_cache_get_stats:
+ * @cache: A shape cache
+ * @hits: (out) (optional): Number of runs served from the cache
+ * @misses: (out) (optional): Number of cacheable runs that had to be shaped
+ *
+ * Fetches the number of cache hits and misses of @cache since it was
+ * created.  Runs that are not eligible for caching (for example, runs
+ * longer than the cached run length) are counted as neither.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_cache_get_stats (const hb_shape_cache_t *cache,
+			  unsigned int           *hits,
+			  unsigned int           *misses)
+{
+  if (hits) *hits = cache->hits;
+  if (misses) *misses = cache->misses;
+}
+
+/**
+ * hb_shape_cache_shape_full:
+ * @cache: A shape cache
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * Like hb_shape_full(), but consults @cache first and, on a miss, records
+ * the result in @cache.  Only short runs of Unicode text are cached;
+ * everything else, as well as buffers with a message function set or
+ * with #HB_BUFFER_FLAG_VERIFY, is passed through to hb_shape_full().
+ *
+ * The cached result is reused only for the same @font object with
+ * the same settings; the cache holds a reference to the fonts it has
+ * results for until those results are evicted or the cache is cleared.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_cache_shape_full (hb_shape_cache_t   *cache,
+			   hb_font_t          *font,
+			   hb_buffer_t        *buffer,
+			   const hb_feature_t *features,
+			   unsigned int        num_features,
+			   const char * const *shaper_list)
+{
+  if (unlikely (!buffer->len))
+    return true;
+
+  if (unlikely (hb_object_is_immutable (cache)) ||
+      !hb_shape_cache_t::may_cache (buffer))
+    return hb_shape_full (font, buffer, features, num_features, shaper_list);
+
+  hb_shape_plan_t *shape_plan = hb_shape_plan_create_cached2 (font->face, &buffer->props,
+							      features, num_features,
+							      font->coords, font->num_coords,
+							      shaper_list);
+
+  hb_vector_t<uint32_t> key;
+  if (unlikely (!hb_shape_cache_t::make_key (key, shape_plan, font, buffer,
+					     features, num_features)))
+  {
+    hb_shape_plan_destroy (shape_plan);
+    return hb_shape_full (font, buffer, features, num_features, shaper_list);
+  }
+
+  if (cache->lookup (key, buffer))
+  {
+    hb_shape_plan_destroy (shape_plan);
+    return true;
+  }
+
+  uint32_t base = buffer->info[0].cluster;
+
+  buffer->enter ();
+
+  hb_bool_t res = hb_shape_plan_execute (shape_plan, font, buffer, features, num_features);
+
+  if (buffer->max_ops <= 0)
+    buffer->shaping_failed = true;
+
+  buffer->leave ();
+
+  if (res && buffer->successful && !buffer->shaping_failed)
+    cache->insert (std::move (key), shape_plan, font, buffer, base);
+
+  hb_shape_plan_destroy (shape_plan);
+
+  return res;
+}
+
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_SHAPE_CACHE_HH
+#define HB_SHAPE_CACHE_HH
+
+#include "hb.hh"
+
+#include "hb-buffer.hh"
+#include "hb-font.hh"
+#include "hb-map.hh"
+#include "hb-mutex.hh"
+#include "hb-shape-plan.hh"
+#include "hb-vector.hh"
+
+
+#ifndef HB_SHAPE_CACHE_MAX_RUN_LENGTH
+#define HB_SHAPE_CACHE_MAX_RUN_LENGTH 32
+#endif
+
+#ifndef HB_SHAPE_CACHE_DEFAULT_MAX_ENTRIES
+#define HB_SHAPE_CACHE_DEFAULT_MAX_ENTRIES 4096
+#endif
+
+
+/* A cache of shaping results for short runs.
+ *
+ * The key is a flat array of 32-bit words built from everything that
+ * can influence the shaping output: the shape-plan and font (by pointer;
+ * each entry holds a reference to both so the pointers cannot be reused
+ * while cached), the font serials, the buffer flags and settings, the
+ * random state, the user features, the pre/post context, and the
+ * codepoints of the run along with their clusters relative to the first
+ * one.  The random state the run leaves behind, which the `rand` feature
+ * advances, is stored with the result and restored on replay.
+ *
+ * Output clusters are stored relative to the first input cluster too,
+ * so the same word cached at one offset in the text can be replayed at
+ * any other offset.
+ *
+ * Entries are kept in a doubly-linked LRU list threaded through the
+ * entries array; when the cache is full the least-recently-used entry
+ * is recycled.  All access is serialized with a mutex; shaping itself
+ * happens outside the lock.
+ */
+
+struct hb_shape_cache_entry_t
+{
+  hb_vector_t<uint32_t> key;
+  hb_shape_plan_t *shape_plan;
+  hb_font_t *font;
+  hb_vector_t<hb_glyph_info_t> info;
+  hb_vector_t<hb_glyph_position_t> pos;
+  uint32_t random_state;
+  unsigned prev;
+  unsigned next;
+
+  void release ()
+  {
+    hb_shape_plan_destroy (shape_plan);
+    shape_plan = nullptr;
+    hb_font_destroy (font);
+    font = nullptr;
+  }
+};
+
+struct hb_shape_cache_t
+{
+  static constexpr unsigned NIL = (unsigned) -1;
+
+  hb_shape_cache_t (unsigned max_entries_) : max_entries (max_entries_) {}
+  ~hb_shape_cache_t () { clear (); }
+
+  hb_object_header_t header;
+
+  hb_mutex_t lock;
+  unsigned max_entries;
+  hb_vector_t<hb_shape_cache_entry_t> entries;
+  hb_hashmap_t<hb_vector_t<uint32_t>, unsigned> map; /* key -> index into entries. */
+  unsigned head = NIL; /* Most-recently used. */
+  unsigned tail = NIL; /* Least-recently used. */
+
+  hb_atomic_int_t hits;
+  hb_atomic_int_t misses;
+
+  static bool may_cache (hb_buffer_t *buffer)
+  {
+    return buffer->len <= HB_SHAPE_CACHE_MAX_RUN_LENGTH &&
+	   buffer->content_type == HB_BUFFER_CONTENT_TYPE_UNICODE &&
+	   !(buffer->flags & HB_BUFFER_FLAG_VERIFY) &&
+	   !buffer->messaging () &&
+	   buffer->successful;
+  }
+
+  static void push_pointer (hb_vector_t<uint32_t> &key, const void *p)
+  {
+    uint64_t v = (uint64_t) (uintptr_t) p;
+    key.push ((uint32_t) v);
+    key.push ((uint32_t) (v >> 32));
+  }
+
+  static bool make_key (hb_vector_t<uint32_t> &key,
+			const hb_shape_plan_t *shape_plan,
+			const hb_font_t *font,
+			const hb_buffer_t *buffer,
+			const hb_feature_t *features,
+			unsigned num_features)
+  {
+    if (unlikely (!key.alloc (25 + 4 * num_features +
+			      2 * hb_buffer_t::CONTEXT_LENGTH +
+			      2 * buffer->len, true)))
+      return false;
+
+    push_pointer (key, shape_plan);
+    push_pointer (key, font);
+    key.push (font->serial);
+    key.push (font->serial_coords);
+
+    push_pointer (key, buffer->unicode);
+    key.push (buffer->flags);
+    key.push (buffer->cluster_level);
+    key.push (buffer->replacement);
+    key.push (buffer->invisible);
+    key.push (buffer->not_found);
+    key.push (buffer->not_found_variation_selector);
+    key.push (buffer->random_state);
+
+    key.push (num_features);
+    for (unsigned i = 0; i < num_features; i++)
+    {
+      key.push (features[i].tag);
+      key.push (features[i].value);
+      key.push (features[i].start);
+      key.push (features[i].end);
+    }
+
+    for (unsigned side = 0; side < 2; side++)
+    {
+      key.push (buffer->context_len[side]);
+      for (unsigned i = 0; i < buffer->context_len[side]; i++)
+	key.push (buffer->context[side][i]);
+    }
+
+    unsigned count = buffer->len;
+    uint32_t base = buffer->info[0].cluster;
+    key.push (count);
+    for (unsigned i = 0; i < count; i++)
+    {
+      key.push (buffer->info[i].codepoint);
+      key.push (buffer->info[i].cluster - base);
+    }
+
+    return !key.in_error ();
+  }
+
+  void unlink (unsigned i)
+  {
+    auto &e = entries.arrayZ[i];
+    if (e.prev != NIL) entries.arrayZ[e.prev].next = e.next; else head = e.next;
+    if (e.next != NIL) entries.arrayZ[e.next].prev = e.prev; else tail = e.prev;
+    e.prev = e.next = NIL;
+  }
+
+  void link_front (unsigned i)
+  {
+    auto &e = entries.arrayZ[i];
+    e.prev = NIL;
+    e.next = head;
+    if (head != NIL) entries.arrayZ[head].prev = i;
+    head = i;
+    if (tail == NIL) tail = i;
+  }
+
+  void link_back (unsigned i)
+  {
+    auto &e = entries.arrayZ[i];
+    e.next = NIL;
+    e.prev = tail;
+    if (tail != NIL) entries.arrayZ[tail].next = i;
+    tail = i;
+    if (head == NIL) head = i;
+  }
+
+  /* Replays a cached result into buffer.  Returns false on miss. */
+  bool lookup (const hb_vector_t<uint32_t> &key, hb_buffer_t *buffer)
+  {
+    hb_lock_t l (lock);
+
+    unsigned *v;
+    if (!map.has (key, &v))
+    {
+      misses.inc ();
+      return false;
+    }
+    unsigned i = *v;
+
+    const auto &e = entries.arrayZ[i];
+    unsigned count = e.info.length;
+    if (unlikely (!buffer->ensure (count)))
+      return false;
+
+    uint32_t base = buffer->info[0].cluster;
+
+    hb_memcpy (buffer->info, e.info.arrayZ, count * sizeof (buffer->info[0]));
+    hb_memcpy (buffer->pos, e.pos.arrayZ, count * sizeof (buffer->pos[0]));
+    for (unsigned j = 0; j < count; j++)
+      buffer->info[j].cluster += base;
+
+    buffer->len = count;
+    buffer->have_output = false;
+    buffer->have_positions = true;
+    buffer->content_type = HB_BUFFER_CONTENT_TYPE_GLYPHS;
+    buffer->random_state = e.random_state;
+
+    if (head != i)
+    {
+      unlink (i);
+      link_front (i);
+    }
+
+    hits.inc ();
+    return true;
+  }
+
+  /* Records the shaped contents of buffer.  Best-effort; allocation
+   * failures just leave the result uncached. */
+  void insert (hb_vector_t<uint32_t> &&key,
+	       hb_shape_plan_t *shape_plan,
+	       hb_font_t *font,
+	       const hb_buffer_t *buffer,
+	       uint32_t base)
+  {
+    hb_lock_t l (lock);
+
+    if (map.has (key))
+      return; /* Another thread beat us to it. */
+
+    unsigned i;
+    if (entries.length < max_entries)
+    {
+      i = entries.length;
+      if (unlikely (!entries.resize (entries.length + 1)))
+	return;
+      entries.arrayZ[i].prev = entries.arrayZ[i].next = NIL;
+    }
+    else
+    {
+      i = tail;
+      unlink (i);
+      map.del (entries.arrayZ[i].key);
+      entries.arrayZ[i].release ();
+    }
+
+    auto &e = entries.arrayZ[i];
+    unsigned count = buffer->len;
+    if (unlikely (!e.info.resize (count, false) ||
+		  !e.pos.resize (count, false) ||
+		  !map.set (key, i)))
+    {
+      /* Park the empty slot at the tail so it is recycled first. */
+      e.key.resize (0);
+      link_back (i);
+      return;
+    }
+
+    hb_memcpy (e.info.arrayZ, buffer->info, count * sizeof (buffer->info[0]));
+    hb_memcpy (e.pos.arrayZ, buffer->pos, count * sizeof (buffer->pos[0]));
+    for (unsigned j = 0; j < count; j++)
+      e.info.arrayZ[j].cluster -= base;
+    e.random_state = buffer->random_state;
+
+    e.key = std::move (key);
+    e.shape_plan = hb_shape_plan_reference (shape_plan);
+    e.font = hb_font_reference (font);
+    link_front (i);
+  }
+
+  void clear ()
+  {
+    hb_lock_t l (lock);
+
+    for (auto &e : entries)
+      e.release ();
+    entries.fini ();
+    map.reset ();
+    head = tail = NIL;
+  }
+};
+
+
+#endif /* HB_SHAPE_CACHE_HH */
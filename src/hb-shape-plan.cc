@@ -165,6 +165,27 @@ hb_shape_plan_key_t::equal (const hb_shape_plan_key_t *other)
 	 this->shaper_func == other->shaper_func;
 }
 
+uint32_t
+hb_shape_plan_key_t::hash () const
+{
+  uint32_t h = hb_segment_properties_hash (&props);
+  h = h * 31 + hb_hash (num_user_features);
+  for (unsigned int i = 0; i < num_user_features; i++)
+  {
+    const hb_feature_t &f = user_features[i];
+    h = h * 31 + hb_hash (f.tag);
+    h = h * 31 + hb_hash (f.value);
+    h = h * 31 + (f.start == HB_FEATURE_GLOBAL_START &&
+		  f.end   == HB_FEATURE_GLOBAL_END);
+  }
+#ifndef HB_NO_OT_SHAPE
+  h = h * 31 + hb_hash (ot.variations_index[0]);
+  h = h * 31 + hb_hash (ot.variations_index[1]);
+#endif
+  h = h * 31 + hb_hash ((const void *) shaper_func);
+  return h;
+}
+
 
 /*
  * hb_shape_plan_t
@@ -491,6 +512,172 @@ hb_shape_plan_create_cached (hb_face_t                     *face,
 				       shaper_list);
 }
 
+/*
+ * Shape-plan cache.
+ *
+ * Each bucket holds a fixed number of plan slots.  Lookups read the slots
+ * without locking; inserting a plan swaps it into an empty or the least
+ * recently used slot with a compare-and-swap.  A plan swapped out might
+ * still be looked at by a thread that read the slot just before, so it
+ * goes on the bucket's retired list, which is only destroyed while no
+ * thread is between entering and leaving a lookup of that bucket.
+ */
+
+static hb_face_t::plan_cache_t *
+_hb_face_get_plan_cache (hb_face_t *face)
+{
+retry:
+  hb_face_t::plan_cache_t *cache = face->shape_plans.get_acquire ();
+  if (unlikely (!cache))
+  {
+    cache = (hb_face_t::plan_cache_t *) hb_calloc (1, sizeof (*cache));
+    if (unlikely (!cache))
+      return nullptr;
+
+    if (unlikely (!face->shape_plans.cmpexch (nullptr, cache)))
+    {
+      hb_free (cache);
+      goto retry;
+    }
+  }
+  return cache;
+}
+
+/* Returns a new reference to the cached plan for key, or nullptr. */
+static hb_shape_plan_t *
+_hb_plan_bucket_find (hb_face_t::plan_bucket_t *bucket,
+		      const hb_shape_plan_key_t *key)
+{
+  hb_shape_plan_t *found = nullptr;
+
+  bucket->readers.inc ();
+  for (unsigned i = 0; i < hb_face_t::plan_bucket_t::WAYS; i++)
+  {
+    hb_shape_plan_t *plan = bucket->plans[i].get_acquire ();
+    if (plan && plan->key.equal (key))
+    {
+      found = hb_shape_plan_reference (plan);
+      bucket->last_used[i].set_relaxed (bucket->clock.inc ());
+      break;
+    }
+  }
+  bucket->readers.dec ();
+
+  return found;
+}
+
+/* Pushes the list from first to last onto the retired list. */
+static void
+_hb_plan_bucket_retire (hb_face_t::plan_bucket_t *bucket,
+			hb_face_t::plan_node_t *first,
+			hb_face_t::plan_node_t *last)
+{
+  hb_face_t::plan_node_t *head;
+  do
+  {
+    head = bucket->retired.get_acquire ();
+    last->next = head;
+  }
+  while (!bucket->retired.cmpexch (head, first));
+}
+
+static void
+_hb_plan_bucket_reclaim (hb_face_t::plan_bucket_t *bucket)
+{
+  hb_face_t::plan_node_t *list;
+  do
+    list = bucket->retired.get_acquire ();
+  while (list && !bucket->retired.cmpexch (list, nullptr));
+  if (!list)
+    return;
+
+  /* The plans on the list were swapped out of their slots before they
+   * were retired.  Lookups that enter the bucket after this increment
+   * are ordered after it on readers, so they can't see those plans; if
+   * there were none before it, nobody else can either. */
+  bool unused = bucket->readers.inc () == 0;
+  bucket->readers.dec ();
+
+  if (!unused)
+  {
+    hb_face_t::plan_node_t *last = list;
+    while (last->next)
+      last = last->next;
+    _hb_plan_bucket_retire (bucket, list, last);
+    return;
+  }
+
+  while (list)
+  {
+    hb_face_t::plan_node_t *next = list->next;
+    DEBUG_MSG_FUNC (SHAPE_PLAN, list->shape_plan, "evicted from cache");
+    hb_shape_plan_destroy (list->shape_plan);
+    hb_free (list);
+    list = next;
+  }
+}
+
+/* Caches shape_plan in bucket, evicting the least recently used plan if
+ * the bucket is full.  Best-effort; the plan is left uncached on failure. */
+static void
+_hb_plan_bucket_insert (hb_face_t::plan_bucket_t *bucket,
+			hb_shape_plan_t *shape_plan)
+{
+  constexpr unsigned WAYS = hb_face_t::plan_bucket_t::WAYS;
+
+  hb_face_t::plan_node_t *node = (hb_face_t::plan_node_t *) hb_calloc (1, sizeof (hb_face_t::plan_node_t));
+  if (unlikely (!node))
+    return;
+
+  /* Taken before the plan is visible, as it can be evicted right away. */
+  hb_shape_plan_reference (shape_plan);
+
+  bool inserted = false;
+  for (unsigned attempt = 0; attempt < WAYS && !inserted; attempt++)
+  {
+    unsigned now = bucket->clock.get_relaxed ();
+    unsigned victim = 0, victim_age = 0;
+    hb_shape_plan_t *old = nullptr;
+    for (unsigned i = 0; i < WAYS; i++)
+    {
+      hb_shape_plan_t *plan = bucket->plans[i].get_acquire ();
+      if (!plan)
+      {
+	victim = i;
+	old = nullptr;
+	break;
+      }
+      unsigned age = now - (unsigned) bucket->last_used[i].get_relaxed ();
+      if (!old || age > victim_age)
+      {
+	victim = i;
+	victim_age = age;
+	old = plan;
+      }
+    }
+
+    if (!bucket->plans[victim].cmpexch (old, shape_plan))
+      continue;
+    inserted = true;
+    bucket->last_used[victim].set_relaxed (bucket->clock.inc ());
+    DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
+
+    if (old)
+    {
+      node->shape_plan = old;
+      _hb_plan_bucket_retire (bucket, node, node);
+      node = nullptr;
+      bucket->evictions.inc ();
+    }
+  }
+
+  if (!inserted)
+    hb_shape_plan_destroy (shape_plan);
+  hb_free (node);
+
+  _hb_plan_bucket_reclaim (bucket);
+}
+
 /**
  * hb_shape_plan_create_cached2:
  * @face: #hb_face_t to use
@@ -525,14 +712,12 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 		  num_user_features,
 		  shaper_list);
 
-retry:
-  hb_face_t::plan_node_t *cached_plan_nodes = face->shape_plans;
-
   bool dont_cache = !hb_object_is_valid (face);
 
+  hb_shape_plan_key_t key;
+  hb_face_t::plan_bucket_t *bucket = nullptr;
   if (likely (!dont_cache))
   {
-    hb_shape_plan_key_t key;
     if (!key.init (false,
 		   face,
 		   props,
@@ -543,12 +728,20 @@ retry:
 		   shaper_list))
       return hb_shape_plan_get_empty ();
 
-    for (hb_face_t::plan_node_t *node = cached_plan_nodes; node; node = node->next)
-      if (node->shape_plan->key.equal (&key))
+    hb_face_t::plan_cache_t *cache = _hb_face_get_plan_cache (face);
+    if (likely (cache))
+    {
+      bucket = &cache->buckets[key.hash () % HB_SHAPE_PLAN_CACHE_BUCKETS];
+
+      hb_shape_plan_t *cached = _hb_plan_bucket_find (bucket, &key);
+      if (cached)
       {
-	DEBUG_MSG_FUNC (SHAPE_PLAN, node->shape_plan, "fulfilled from cache");
-	return hb_shape_plan_reference (node->shape_plan);
+	bucket->hits.inc ();
+	DEBUG_MSG_FUNC (SHAPE_PLAN, cached, "fulfilled from cache");
+	return cached;
       }
+      bucket->misses.inc ();
+    }
   }
 
   hb_shape_plan_t *shape_plan = hb_shape_plan_create2 (face, props,
@@ -556,25 +749,60 @@ retry:
 						       coords, num_coords,
 						       shaper_list);
 
-  if (unlikely (dont_cache))
+  if (unlikely (!bucket || !hb_object_is_valid (shape_plan)))
     return shape_plan;
 
-  hb_face_t::plan_node_t *node = (hb_face_t::plan_node_t *) hb_calloc (1, sizeof (hb_face_t::plan_node_t));
-  if (unlikely (!node))
-    return shape_plan;
-
-  node->shape_plan = shape_plan;
-  node->next = cached_plan_nodes;
-
-  if (unlikely (!face->shape_plans.cmpexch (cached_plan_nodes, node)))
+  /* Another thread might have cached the same plan meanwhile. */
+  hb_shape_plan_t *cached = _hb_plan_bucket_find (bucket, &key);
+  if (cached)
   {
     hb_shape_plan_destroy (shape_plan);
-    hb_free (node);
-    goto retry;
+    return cached;
   }
-  DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
 
-  return hb_shape_plan_reference (shape_plan);
+  _hb_plan_bucket_insert (bucket, shape_plan);
+
+  return shape_plan;
+}
+
+/**
+ * hb_shape_plan_get_cache_stats:
+ * @face: #hb_face_t to work upon
+ * @hits: (out) (optional): Number of plans found in the cache
+ * @misses: (out) (optional): Number of plans that had to be created
+ * @evictions: (out) (optional): Number of plans evicted to keep the cache
+ *    within its size
+ * @plans: (out) (optional): Number of plans currently cached
+ *
+ * Fetches statistics of the cache of shape plans kept on @face, as used
+ * by hb_shape_plan_create_cached2() and hb_shape().
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_plan_get_cache_stats (hb_face_t    *face,
+			       unsigned int *hits,
+			       unsigned int *misses,
+			       unsigned int *evictions,
+			       unsigned int *plans)
+{
+  unsigned total_hits = 0, total_misses = 0, total_evictions = 0, total_plans = 0;
+
+  hb_face_t::plan_cache_t *cache = hb_object_is_valid (face) ? face->shape_plans.get_acquire () : nullptr;
+  if (cache)
+    for (auto &bucket : cache->buckets)
+    {
+      total_hits += bucket.hits.get_relaxed ();
+      total_misses += bucket.misses.get_relaxed ();
+      total_evictions += bucket.evictions.get_relaxed ();
+      for (auto &plan : bucket.plans)
+	total_plans += !!plan.get_relaxed ();
+    }
+
+  if (hits) *hits = total_hits;
+  if (misses) *misses = total_misses;
+  if (evictions) *evictions = total_evictions;
+  if (plans) *plans = total_plans;
 }
 
 
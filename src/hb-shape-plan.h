@@ -85,6 +85,13 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 			      const char * const            *shaper_list);
 
 
+HB_EXTERN void
+hb_shape_plan_get_cache_stats (hb_face_t    *face,
+			       unsigned int *hits,
+			       unsigned int *misses,
+			       unsigned int *evictions,
+			       unsigned int *plans);
+
 HB_EXTERN hb_shape_plan_t *
 hb_shape_plan_get_empty (void);
 
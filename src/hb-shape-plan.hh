@@ -60,6 +60,9 @@ struct hb_shape_plan_key_t
   HB_INTERNAL bool user_features_match (const hb_shape_plan_key_t *other);
 
   HB_INTERNAL bool equal (const hb_shape_plan_key_t *other);
+
+  /* Consistent with equal (). */
+  HB_INTERNAL uint32_t hash () const;
 };
 
 struct hb_shape_plan_t
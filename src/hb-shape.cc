@@ -170,6 +170,81 @@ hb_shape_full (hb_font_t          *font,
   return res;
 }
 
+/**
+ * hb_shape_batch:
+ * @font: an #hb_font_t to use for shaping
+ * @buffers: (array length=num_buffers): an array of #hb_buffer_t to shape
+ * @num_buffers: the length of @buffers array
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * Shapes each of @buffers in turn using @font, as if by calling
+ * hb_shape_full() on each, but amortizing the per-call setup over the
+ * whole batch: the shaping plan is looked up once and reused for as long
+ * as consecutive buffers share the same segment properties.
+ *
+ * This is most useful when shaping many short runs, such as the words
+ * of a paragraph, with the same font and features.
+ *
+ * Return value: false if all shapers failed for any of the buffers,
+ * true otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_batch (hb_font_t          *font,
+		hb_buffer_t       **buffers,
+		unsigned int        num_buffers,
+		const hb_feature_t *features,
+		unsigned int        num_features,
+		const char * const *shaper_list)
+{
+  hb_bool_t ret = true;
+  hb_shape_plan_t *shape_plan = nullptr;
+
+  for (unsigned int i = 0; i < num_buffers; i++)
+  {
+    hb_buffer_t *buffer = buffers[i];
+
+    if (unlikely (!buffer->len))
+      continue;
+
+    if (unlikely (buffer->flags & HB_BUFFER_FLAG_VERIFY))
+    {
+      if (!hb_shape_full (font, buffer, features, num_features, shaper_list))
+	ret = false;
+      continue;
+    }
+
+    if (!shape_plan ||
+	!hb_segment_properties_equal (&shape_plan->key.props, &buffer->props))
+    {
+      hb_shape_plan_destroy (shape_plan);
+      shape_plan = hb_shape_plan_create_cached2 (font->face, &buffer->props,
+						 features, num_features,
+						 font->coords, font->num_coords,
+						 shaper_list);
+    }
+
+    buffer->enter ();
+
+    if (!hb_shape_plan_execute (shape_plan, font, buffer, features, num_features))
+      ret = false;
+
+    if (buffer->max_ops <= 0)
+      buffer->shaping_failed = true;
+
+    buffer->leave ();
+  }
+
+  hb_shape_plan_destroy (shape_plan);
+
+  return ret;
+}
+
 /**
  * hb_shape:
  * @font: an #hb_font_t to use for shaping
@@ -53,6 +53,14 @@ hb_shape_full (hb_font_t          *font,
 	       unsigned int        num_features,
 	       const char * const *shaper_list);
 
+HB_EXTERN hb_bool_t
+hb_shape_batch (hb_font_t          *font,
+		hb_buffer_t       **buffers,
+		unsigned int        num_buffers,
+		const hb_feature_t *features,
+		unsigned int        num_features,
+		const char * const *shaper_list);
+
 HB_EXTERN hb_bool_t
 hb_shape_justify (hb_font_t          *font,
 		  hb_buffer_t        *buffer,
@@ -69,6 +77,55 @@ HB_EXTERN const char **
 hb_shape_list_shapers (void);
 
 
+/**
+ * hb_shape_cache_t:
+ *
+ * Data type for holding a cache of shaping results.
+ *
+ * XSince: REPLACEME
+ **/
+typedef struct hb_shape_cache_t hb_shape_cache_t;
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_create (unsigned int max_entries);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_get_empty (void);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache);
+
+HB_EXTERN void
+hb_shape_cache_destroy (hb_shape_cache_t *cache);
+
+HB_EXTERN hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_shape_cache_get_user_data (const hb_shape_cache_t *cache,
+			      hb_user_data_key_t     *key);
+
+HB_EXTERN void
+hb_shape_cache_clear (hb_shape_cache_t *cache);
+
+HB_EXTERN void
+hb_shape_cache_get_stats (const hb_shape_cache_t *cache,
+			  unsigned int           *hits,
+			  unsigned int           *misses);
+
+HB_EXTERN hb_bool_t
+hb_shape_cache_shape_full (hb_shape_cache_t   *cache,
+			   hb_font_t          *font,
+			   hb_buffer_t        *buffer,
+			   const hb_feature_t *features,
+			   unsigned int        num_features,
+			   const char * const *shaper_list);
+
+
 HB_END_DECLS
 
 #endif /* HB_SHAPE_H */
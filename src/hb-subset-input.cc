@@ -334,6 +334,54 @@ hb_subset_input_set_flags (hb_subset_input_t *input,
   input->flags = (hb_subset_flags_t) value;
 }
 
+/**
+ * hb_subset_input_set_executor:
+ * @input: a #hb_subset_input_t object.
+ * @func: (closure user_data) (nullable): the executor to run subsetting tasks with,
+ *   or `NULL` to use the default
+ * @user_data: data to pass to @func
+ *
+ * Sets the function used to run table subsetting tasks concurrently when
+ * #HB_SUBSET_FLAGS_PARALLEL is set.  This lets clients run the tasks on
+ * their own thread pool.  @user_data must stay valid for as long as
+ * @input, and any plan created from it, is in use.
+ *
+ * XSince: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_executor (hb_subset_input_t         *input,
+			      hb_subset_executor_func_t  func,
+			      void                      *user_data)
+{
+  input->executor = func;
+  input->executor_data = user_data;
+}
+
+/**
+ * hb_subset_input_set_stage_func:
+ * @input: a #hb_subset_input_t object.
+ * @func: (closure user_data) (nullable): the function to report stages to,
+ *   or `NULL` to not report them
+ * @user_data: data to pass to @func
+ *
+ * Sets a function to be called as each stage of subsetting with @input
+ * starts and ends, to find out where the time of a subsetting operation
+ * goes.  See #hb_subset_stage_t for the stages reported.  When no
+ * function is set, which is the default, stages cost nothing to track.
+ * @user_data must stay valid for as long as @input, and any plan created
+ * from it, is in use.
+ *
+ * XSince: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_stage_func (hb_subset_input_t      *input,
+				hb_subset_stage_func_t  func,
+				void                   *user_data)
+{
+  input->stage_func = func;
+  input->stage_data = user_data;
+}
+
 /**
  * hb_subset_input_set_user_data: (skip)
  * @input: a #hb_subset_input_t object.
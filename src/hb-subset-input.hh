@@ -119,6 +119,11 @@ struct hb_subset_input_t
   // If set loca format will always be the long version.
   bool force_long_loca = false;
 
+  hb_subset_executor_func_t executor = nullptr;
+  void *executor_data = nullptr;
+  hb_subset_stage_func_t stage_func = nullptr;
+  void *stage_data = nullptr;
+
   hb_hashmap_t<hb_tag_t, Triple> axes_location;
   hb_map_t glyph_map;
 #ifdef HB_EXPERIMENTAL_API
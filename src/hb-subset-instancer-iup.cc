@@ -172,105 +172,95 @@ static bool rotate_set (const hb_set_t& org_set,
   return !out.in_error ();
 }
 
-/* Given two reference coordinates (start and end of contour_points array),
- * output interpolated deltas for points in between */
-static bool _iup_segment (const hb_array_t<const contour_point_t> contour_points,
-                          const hb_array_t<const int> x_deltas,
-                          const hb_array_t<const int> y_deltas,
-                          const contour_point_t& p1, const contour_point_t& p2,
-                          int p1_dx, int p2_dx,
-                          int p1_dy, int p2_dy,
-                          hb_vector_t<double>& interp_x_deltas, /* OUT */
-                          hb_vector_t<double>& interp_y_deltas /* OUT */)
+/* Given two reference coordinates and their deltas, interpolates the deltas
+ * for coordinates in between. */
+struct iup_segment_t
 {
-  unsigned n = contour_points.length;
-  if (unlikely (!interp_x_deltas.resize (n, false) ||
-                !interp_y_deltas.resize (n, false)))
-    return false;
-
-  for (unsigned j = 0; j < 2; j++)
+  iup_segment_t (double x1_, double x2_, double d1_, double d2_)
   {
-    double x1, x2, d1, d2;
-    double *out;
-    if (j == 0)
-    {
-      x1 = static_cast<double> (p1.x);
-      x2 = static_cast<double> (p2.x);
-      d1 = p1_dx;
-      d2 = p2_dx;
-      out = interp_x_deltas.arrayZ;
-    }
-    else
+    if (x1_ > x2_)
     {
-      x1 = static_cast<double> (p1.y);
-      x2 = static_cast<double> (p2.y);
-      d1 = p1_dy;
-      d2 = p2_dy;
-      out = interp_y_deltas.arrayZ;
+      hb_swap (x1_, x2_);
+      hb_swap (d1_, d2_);
     }
-
+    x1 = x1_;
+    x2 = x2_;
     if (x1 == x2)
     {
-      if (d1 == d2)
-      {
-        for (unsigned i = 0; i < n; i++)
-          out[i] = d1;
-      }
-      else
-      {
-        for (unsigned i = 0; i < n; i++)
-          out[i] = 0.0;
-      }
-      continue;
+      d1 = d2 = (d1_ == d2_) ? d1_ : 0.0;
+      scale = 0.0;
     }
-
-    if (x1 > x2)
+    else
     {
-      hb_swap (x1, x2);
-      hb_swap (d1, d2);
+      d1 = d1_;
+      d2 = d2_;
+      scale = (d2 - d1) / (x2 - x1);
     }
+  }
 
-    double scale = (d2 - d1) / (x2 - x1);
-    for (unsigned i = 0; i < n; i++)
-    {
-      double x = (j == 0 ? static_cast<double> (contour_points.arrayZ[i].x) : static_cast<double> (contour_points.arrayZ[i].y));
-      double d;
-      if (x <= x1)
-        d = d1;
-      else if (x >= x2)
-        d = d2;
-      else
-        d = d1 + (x - x1) * scale;
-
-      out[i] = d;
-    }
+  /* Branch-free, so that it vectorizes. */
+  double operator () (double x) const
+  {
+    double d = d1 + (x - x1) * scale;
+    d = x >= x2 ? d2 : d;
+    return x <= x1 ? d1 : d;
   }
-  return true;
-}
 
-static bool _can_iup_in_between (const hb_array_t<const contour_point_t> contour_points,
-                                 const hb_array_t<const int> x_deltas,
-                                 const hb_array_t<const int> y_deltas,
-                                 const contour_point_t& p1, const contour_point_t& p2,
+  double x1, x2, d1, d2, scale;
+};
+
+/* Compiler-assisted vectorization: the distances are computed in blocks of
+ * a fixed size, so that compilers can vectorize them. */
+constexpr static unsigned BLOCK_SIZE = 8;
+
+static bool _can_iup_in_between (const double *xs, const double *ys,
+                                 const int *x_deltas, const int *y_deltas,
+                                 unsigned num,
+                                 double p1_x, double p2_x,
+                                 double p1_y, double p2_y,
                                  int p1_dx, int p2_dx,
                                  int p1_dy, int p2_dy,
                                  double tolerance)
 {
-  hb_vector_t<double> interp_x_deltas, interp_y_deltas;
-  if (!_iup_segment (contour_points, x_deltas, y_deltas,
-                     p1, p2, p1_dx, p2_dx, p1_dy, p2_dy,
-                     interp_x_deltas, interp_y_deltas))
-    return false;
+  iup_segment_t segment_x (p1_x, p2_x, p1_dx, p2_dx);
+  iup_segment_t segment_y (p1_y, p2_y, p1_dy, p2_dy);
 
-  unsigned num = contour_points.length;
+  auto distance_squared = [&] (unsigned i)
+  {
+    double dx = static_cast<double> (x_deltas[i]) - segment_x (xs[i]);
+    double dy = static_cast<double> (y_deltas[i]) - segment_y (ys[i]);
+    return dx * dx + dy * dy;
+  };
 
-  for (unsigned i = 0; i < num; i++)
+  unsigned i = 0;
+  for (; i + BLOCK_SIZE <= num; i += BLOCK_SIZE)
   {
-    double dx = static_cast<double> (x_deltas.arrayZ[i]) - interp_x_deltas.arrayZ[i];
-    double dy = static_cast<double> (y_deltas.arrayZ[i]) - interp_y_deltas.arrayZ[i];
-  
-    if (sqrt (dx * dx + dy * dy) > tolerance)
+    double d[BLOCK_SIZE];
+    for (unsigned j = 0; j < BLOCK_SIZE; j++)
+      d[j] = distance_squared (i + j);
+    for (unsigned j = 0; j < BLOCK_SIZE; j++)
+      if (sqrt (d[j]) > tolerance)
+        return false;
+  }
+  for (; i < num; i++)
+    if (sqrt (distance_squared (i)) > tolerance)
       return false;
+  return true;
+}
+
+static bool _split_coords (const hb_array_t<const contour_point_t> points,
+                           hb_vector_t<double>& xs, /* OUT */
+                           hb_vector_t<double>& ys /* OUT */)
+{
+  unsigned n = points.length;
+  if (unlikely (!xs.resize (n, false) ||
+                !ys.resize (n, false)))
+    return false;
+
+  for (unsigned i = 0; i < n; i++)
+  {
+    xs.arrayZ[i] = static_cast<double> (points.arrayZ[i].x);
+    ys.arrayZ[i] = static_cast<double> (points.arrayZ[i].y);
   }
   return true;
 }
@@ -285,8 +275,10 @@ static bool _iup_contour_optimize_dp (const contour_point_vector_t& contour_poin
                                       hb_vector_t<int>& chain /* OUT */)
 {
   unsigned n = contour_points.length;
+  hb_vector_t<double> xs, ys;
   if (unlikely (!costs.resize (n, false) ||
-                !chain.resize (n, false)))
+                !chain.resize (n, false) ||
+                !_split_coords (contour_points, xs, ys)))
     return false;
 
   lookback = hb_min (lookback, MAX_LOOKBACK);
@@ -309,10 +301,11 @@ static bool _iup_contour_optimize_dp (const contour_point_vector_t& contour_poin
       unsigned num_points = i - j - 1;
       unsigned p1 = (j == -1 ? n - 1 : j);
       if (cost < best_cost &&
-          _can_iup_in_between (contour_points.as_array ().sub_array (j + 1, num_points),
-                               x_deltas.as_array ().sub_array (j + 1, num_points),
-                               y_deltas.as_array ().sub_array (j + 1, num_points),
-                               contour_points.arrayZ[p1], contour_points.arrayZ[i],
+          _can_iup_in_between (xs.arrayZ + j + 1, ys.arrayZ + j + 1,
+                               x_deltas.arrayZ + j + 1, y_deltas.arrayZ + j + 1,
+                               num_points,
+                               xs.arrayZ[p1], xs.arrayZ[i],
+                               ys.arrayZ[p1], ys.arrayZ[i],
                                x_deltas.arrayZ[p1], x_deltas.arrayZ[i],
                                y_deltas.arrayZ[p1], y_deltas.arrayZ[i],
                                tolerance))
@@ -441,17 +434,14 @@ static bool _iup_contour_optimize (const hb_array_t<const contour_point_t> conto
       return false;
 
     unsigned contour_point_size = hb_static_size (contour_point_t);
-    for (unsigned i = 0; i < n; i++)
-    {
-      hb_memcpy ((void *) repeat_x_deltas.arrayZ, (const void *) x_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
-      hb_memcpy ((void *) (repeat_x_deltas.arrayZ + n), (const void *) x_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
+    hb_memcpy ((void *) repeat_x_deltas.arrayZ, (const void *) x_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
+    hb_memcpy ((void *) (repeat_x_deltas.arrayZ + n), (const void *) x_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
 
-      hb_memcpy ((void *) repeat_y_deltas.arrayZ, (const void *) y_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
-      hb_memcpy ((void *) (repeat_y_deltas.arrayZ + n), (const void *) y_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
+    hb_memcpy ((void *) repeat_y_deltas.arrayZ, (const void *) y_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
+    hb_memcpy ((void *) (repeat_y_deltas.arrayZ + n), (const void *) y_deltas.arrayZ, n * sizeof (repeat_x_deltas[0]));
 
-      hb_memcpy ((void *) repeat_points.arrayZ, (const void *) contour_points.arrayZ, n * contour_point_size);
-      hb_memcpy ((void *) (repeat_points.arrayZ + n), (const void *) contour_points.arrayZ, n * contour_point_size);
-    }
+    hb_memcpy ((void *) repeat_points.arrayZ, (const void *) contour_points.arrayZ, n * contour_point_size);
+    hb_memcpy ((void *) (repeat_points.arrayZ + n), (const void *) contour_points.arrayZ, n * contour_point_size);
 
     hb_vector_t<unsigned> costs;
     hb_vector_t<int> chain;
@@ -46,6 +46,8 @@
 #include "hb-ot-stat-table.hh"
 #include "hb-ot-math-table.hh"
 
+#include <time.h>
+
 using OT::Layout::GSUB;
 using OT::Layout::GPOS;
 
@@ -62,6 +64,113 @@ hb_subset_accelerator_t::~hb_subset_accelerator_t ()
   hb_face_destroy (source);
 }
 
+uint64_t
+_hb_subset_stage_now_ns ()
+{
+#if defined(_WIN32)
+  LARGE_INTEGER count, frequency;
+  if (!QueryPerformanceCounter (&count) || !QueryPerformanceFrequency (&frequency))
+    return 0;
+  return (uint64_t) (count.QuadPart / (double) frequency.QuadPart * 1e9);
+#elif defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  if (clock_gettime (CLOCK_MONOTONIC, &ts))
+    return 0;
+  return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#else
+  return 0;
+#endif
+}
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+
+#ifndef HB_SUBSET_MAX_THREADS
+#define HB_SUBSET_MAX_THREADS 8
+#endif
+
+struct hb_subset_thread_pool_t
+{
+  unsigned num_tasks;
+  hb_subset_task_func_t task;
+  void *task_data;
+  hb_atomic_int_t next;
+
+  static void *worker (void *arg)
+  {
+    auto *pool = (hb_subset_thread_pool_t *) arg;
+    unsigned i;
+    while ((i = (unsigned) pool->next.inc ()) < pool->num_tasks)
+      pool->task (i, pool->task_data);
+    return nullptr;
+  }
+};
+#endif
+
+/* Used when the client did not provide an executor: runs the tasks on
+ * short-lived threads, with the calling thread taking its share.  Tasks
+ * may call it again, e.g. a table task splitting its glyphs; such nested
+ * calls run inline on the worker, which keeps the number of threads at
+ * HB_SUBSET_MAX_THREADS. */
+static void
+_default_executor (unsigned num_tasks,
+		   hb_subset_task_func_t task,
+		   void *task_data,
+		   void *user_data)
+{
+#ifdef HAVE_PTHREAD
+  const hb_subset_plan_t *plan = (const hb_subset_plan_t *) user_data;
+  if (plan->default_executor_busy.get_acquire ())
+  {
+    for (unsigned i = 0; i < num_tasks; i++)
+      task (i, task_data);
+    return;
+  }
+  plan->default_executor_busy.set_release (1);
+
+  hb_subset_thread_pool_t pool;
+  pool.num_tasks = num_tasks;
+  pool.task = task;
+  pool.task_data = task_data;
+  pool.next = 0;
+
+  pthread_t threads[HB_SUBSET_MAX_THREADS - 1];
+  unsigned num_threads = 0;
+  while (num_threads < hb_min (num_tasks, (unsigned) HB_SUBSET_MAX_THREADS) - 1 &&
+	 !pthread_create (&threads[num_threads], nullptr,
+			  hb_subset_thread_pool_t::worker, &pool))
+    num_threads++;
+
+  hb_subset_thread_pool_t::worker (&pool);
+
+  for (unsigned i = 0; i < num_threads; i++)
+    pthread_join (threads[i], nullptr);
+
+  plan->default_executor_busy.set_release (0);
+#else
+  for (unsigned i = 0; i < num_tasks; i++)
+    task (i, task_data);
+#endif
+}
+
+void
+hb_subset_plan_t::run_tasks (unsigned num_tasks,
+			     hb_subset_task_func_t task,
+			     void *task_data) const
+{
+  if (!(flags & HB_SUBSET_FLAGS_PARALLEL) || num_tasks <= 1)
+  {
+    for (unsigned i = 0; i < num_tasks; i++)
+      task (i, task_data);
+    return;
+  }
+
+  if (executor)
+    executor (num_tasks, task, task_data, executor_data);
+  else
+    _default_executor (num_tasks, task, task_data, (void *) this);
+}
+
 
 typedef hb_hashmap_t<unsigned, hb::unique_ptr<hb_set_t>> script_langsys_map;
 #ifndef HB_NO_SUBSET_CFF
@@ -859,10 +968,36 @@ _nameid_closure (hb_subset_plan_t* plan,
 #endif
 }
 
+/*
+ * Whether the glyph closures computed for @previous can seed those of @plan.
+ * That is the case if @plan is for the same face and settings, and for a
+ * superset of the codepoints and glyphs of @previous: the closures are
+ * monotonic, so closing over the previous closure plus the new seeds gives
+ * the same result as closing over the new seeds alone, with less work.
+ */
+static bool
+_can_reuse_closures (const hb_subset_plan_t *plan,
+		     const hb_subset_plan_t *previous)
+{
+  return previous &&
+	 !previous->in_error () &&
+	 previous->source == plan->source &&
+	 previous->flags == plan->flags &&
+	 previous->unicodes.is_subset (plan->unicodes) &&
+	 previous->glyphs_requested.is_subset (plan->glyphs_requested) &&
+	 previous->layout_features.is_equal (plan->layout_features) &&
+	 previous->layout_scripts.is_equal (plan->layout_scripts) &&
+	 previous->drop_tables.is_equal (plan->drop_tables) &&
+	 previous->user_axes_location.is_equal (plan->user_axes_location);
+}
+
 static void
 _populate_gids_to_retain (hb_subset_plan_t* plan,
-		          hb_set_t* drop_tables)
+		          hb_set_t* drop_tables,
+			  const hb_subset_plan_t *previous)
 {
+  hb_subset_stage_scope_t stage (plan, HB_SUBSET_STAGE_GLYPH_CLOSURE);
+
   OT::glyf_accelerator_t glyf (plan->source);
 #ifndef HB_NO_SUBSET_CFF
   // Note: we cannot use inprogress_accelerator here, since it has not been
@@ -873,11 +1008,15 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
 #endif
 
   plan->_glyphset_gsub.add (0); // Not-def
+  if (previous)
+    plan->_glyphset_gsub.union_ (previous->_glyphset_gsub);
 
   _cmap_closure (plan->source, &plan->unicodes, &plan->_glyphset_gsub);
 
 #ifndef HB_NO_SUBSET_LAYOUT
   if (!drop_tables->has (HB_OT_TAG_GSUB))
+  {
+    hb_subset_stage_scope_t stage (plan, HB_SUBSET_STAGE_LAYOUT_CLOSURE, HB_OT_TAG_GSUB);
     // closure all glyphs/lookups/features needed for GSUB substitutions.
     _closure_glyphs_lookups_features<GSUB> (
         plan,
@@ -889,8 +1028,11 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
         &plan->gsub_feature_substitutes_map,
         plan->gsub_old_features,
         plan->gsub_old_feature_idx_tag_map);
+  }
 
   if (!drop_tables->has (HB_OT_TAG_GPOS))
+  {
+    hb_subset_stage_scope_t stage (plan, HB_SUBSET_STAGE_LAYOUT_CLOSURE, HB_OT_TAG_GPOS);
     _closure_glyphs_lookups_features<GPOS> (
         plan,
         &plan->_glyphset_gsub,
@@ -901,10 +1043,13 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
         &plan->gpos_feature_substitutes_map,
         plan->gpos_old_features,
         plan->gpos_old_feature_idx_tag_map);
+  }
 #endif
   _remove_invalid_gids (&plan->_glyphset_gsub, plan->source->get_num_glyphs ());
 
   plan->_glyphset_mathed = plan->_glyphset_gsub;
+  if (previous)
+    plan->_glyphset_mathed.union_ (previous->_glyphset_mathed);
   if (!drop_tables->has (HB_OT_TAG_MATH))
   {
     _math_closure (plan, &plan->_glyphset_mathed);
@@ -912,8 +1057,11 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
   }
 
   hb_set_t cur_glyphset = plan->_glyphset_mathed;
+  if (previous)
+    cur_glyphset.union_ (previous->_glyphset_colred);
   if (!drop_tables->has (HB_OT_TAG_COLR))
   {
+    hb_subset_stage_scope_t stage (plan, HB_SUBSET_STAGE_COLR_CLOSURE, HB_OT_TAG_COLR);
     _colr_closure (plan, &cur_glyphset);
     _remove_invalid_gids (&cur_glyphset, plan->source->get_num_glyphs ());
   }
@@ -923,6 +1071,11 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
   // XXX TODO VARC closure / subset
 
   _nameid_closure (plan, drop_tables);
+
+  /* Components of the previously retained glyphs are retained already. */
+  if (previous)
+    plan->_glyphset.union_ (previous->_glyphset);
+
   /* Populate a full set of glyphs to retain by adding all referenced
    * composite glyphs. */
   if (glyf.has_data ())
@@ -1249,10 +1402,15 @@ _get_instance_glyphs_contour_points (hb_subset_plan_t *plan)
 #endif
 
 hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
-				    const hb_subset_input_t *input)
+				    const hb_subset_input_t *input,
+				    const hb_subset_plan_t *previous)
 {
   successful = true;
   flags = input->flags;
+  stage_func = input->stage_func;
+  stage_data = input->stage_data;
+
+  hb_subset_stage_scope_t stage (this, HB_SUBSET_STAGE_PLAN);
 
   unicode_to_new_gid_list.init ();
 
@@ -1297,6 +1455,8 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
 
   attach_accelerator_data = input->attach_accelerator_data;
   force_long_loca = input->force_long_loca;
+  executor = input->executor;
+  executor_data = input->executor_data;
 #ifdef HB_EXPERIMENTAL_API
   force_long_loca = force_long_loca || (flags & HB_SUBSET_FLAGS_IFTB_REQUIREMENTS);
 #endif
@@ -1313,7 +1473,10 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
 
   _populate_unicodes_to_retain (input->sets.unicodes, input->sets.glyphs, this);
 
-  _populate_gids_to_retain (this, input->sets.drop_tables);
+  if (!_can_reuse_closures (this, previous))
+    previous = nullptr;
+
+  _populate_gids_to_retain (this, input->sets.drop_tables, previous);
   if (unlikely (in_error ()))
     return;
 
@@ -1439,6 +1602,48 @@ hb_subset_plan_create_or_fail (hb_face_t	 *face,
   return plan;
 }
 
+/**
+ * hb_subset_plan_create_incremental_or_fail:
+ * @face: font face to create the plan for.
+ * @input: a #hb_subset_input_t input.
+ * @previous: (nullable): a plan previously created for @face.
+ *
+ * Like hb_subset_plan_create_or_fail(), but reuses the glyph closures
+ * (layout, MATH, COLR, and composite glyph closures) computed for
+ * @previous, only extending them with what is reachable from the
+ * codepoints and glyphs that @input adds.
+ *
+ * This is meant for repeatedly subsetting the same face with a growing
+ * set of codepoints: keep one #hb_subset_input_t, add to its sets, and
+ * pass the last plan each time.  @previous is only used if @input has
+ * the same settings it was created with and requests a superset of its
+ * codepoints and glyphs; otherwise the plan is computed from scratch.
+ * The resulting plan is the same either way.
+ *
+ * Return value: (transfer full): New subset plan. Destroy with
+ * hb_subset_plan_destroy(). If there is a failure creating the plan
+ * nullptr will be returned.
+ *
+ * XSince: REPLACEME
+ **/
+hb_subset_plan_t *
+hb_subset_plan_create_incremental_or_fail (hb_face_t               *face,
+					   const hb_subset_input_t *input,
+					   const hb_subset_plan_t  *previous)
+{
+  hb_subset_plan_t *plan;
+  if (unlikely (!(plan = hb_object_create<hb_subset_plan_t> (face, input, previous))))
+    return nullptr;
+
+  if (unlikely (plan->in_error ()))
+  {
+    hb_subset_plan_destroy (plan);
+    return nullptr;
+  }
+
+  return plan;
+}
+
 /**
  * hb_subset_plan_destroy:
  * @plan: a #hb_subset_plan_t
@@ -132,10 +132,18 @@ namespace OT {
 struct hb_subset_plan_t
 {
   HB_INTERNAL hb_subset_plan_t (hb_face_t *,
-				const hb_subset_input_t *input);
+				const hb_subset_input_t *input,
+				const hb_subset_plan_t *previous = nullptr);
 
   HB_INTERNAL ~hb_subset_plan_t();
 
+  /* Runs task (i, task_data) for each i below num_tasks and returns once
+   * they have all finished: on the executor with HB_SUBSET_FLAGS_PARALLEL,
+   * in order on the calling thread otherwise. */
+  HB_INTERNAL void run_tasks (unsigned num_tasks,
+			      hb_subset_task_func_t task,
+			      void *task_data) const;
+
   hb_object_header_t header;
 
   bool successful;
@@ -143,6 +151,19 @@ struct hb_subset_plan_t
   bool attach_accelerator_data = false;
   bool force_long_loca = false;
 
+  hb_subset_executor_func_t executor = nullptr;
+  void *executor_data = nullptr;
+  /* Set while the default executor runs tasks of this plan; nested
+   * run_tasks() calls then stay on their thread. */
+  mutable hb_atomic_int_t default_executor_busy;
+
+  hb_subset_stage_func_t stage_func = nullptr;
+  void *stage_data = nullptr;
+
+  // Guard the state shared between tables when they are subset concurrently.
+  hb_mutex_t sanitized_table_cache_lock;
+  hb_mutex_t dest_lock;
+
   // The glyph subset
   hb_map_t *codepoint_to_glyph; // Needs to be heap-allocated
 
@@ -190,20 +211,28 @@ struct hb_subset_plan_t
   {
     hb_blob_ptr_t<T> operator () (hb_subset_plan_t *plan)
     {
-      hb_lock_t lock (plan->accelerator ? &plan->accelerator->sanitized_table_cache_lock : nullptr);
-
+      hb_mutex_t *lock = plan->accelerator ? &plan->accelerator->sanitized_table_cache_lock : &plan->sanitized_table_cache_lock;
       auto *cache = plan->accelerator ? &plan->accelerator->sanitized_table_cache : &plan->sanitized_table_cache;
-      if (cache
-	  && !cache->in_error ()
-	  && cache->has (+T::tableTag)) {
-	return hb_blob_reference (cache->get (+T::tableTag).get ());
+
+      {
+	hb_lock_t l (lock);
+	if (!cache->in_error ()
+	    && cache->has (+T::tableTag)) {
+	  return hb_blob_reference (cache->get (+T::tableTag).get ());
+	}
       }
 
+      /* Sanitize outside the lock, so tables being subset concurrently
+       * don't wait on each other. */
       hb::unique_ptr<hb_blob_t> table_blob {hb_sanitize_context_t ().reference_table<T> (plan->source)};
-      hb_blob_t* ret = hb_blob_reference (table_blob.get ());
 
-      if (likely (cache))
-	cache->set (+T::tableTag, std::move (table_blob));
+      hb_lock_t l (lock);
+      hb::unique_ptr<hb_blob_t> *cached;
+      if (cache->has (+T::tableTag, &cached))
+	return hb_blob_reference (cached->get ());
+
+      hb_blob_t* ret = hb_blob_reference (table_blob.get ());
+      cache->set (+T::tableTag, std::move (table_blob));
 
       return ret;
     }
@@ -294,9 +323,46 @@ struct hb_subset_plan_t
 		hb_blob_get_length (source_blob));
       hb_blob_destroy (source_blob);
     }
+    hb_lock_t l (dest_lock);
     return hb_face_builder_add_table (dest, tag, contents);
   }
 };
 
+HB_INTERNAL uint64_t
+_hb_subset_stage_now_ns ();
+
+/* Reports a stage to the plan's stage function, if one is set, when
+ * constructed and when destroyed. */
+struct hb_subset_stage_scope_t
+{
+  hb_subset_stage_scope_t (const hb_subset_plan_t *plan_,
+			   hb_subset_stage_t stage,
+			   hb_tag_t table_tag = HB_TAG_NONE) :
+    func (plan_->stage_func), data (plan_->stage_data)
+  {
+    if (likely (!func)) return;
+
+    info = hb_subset_stage_info_t ();
+    info.stage = stage;
+    info.table_tag = table_tag;
+    info.start_ns = _hb_subset_stage_now_ns ();
+    func (&info, data);
+  }
+
+  ~hb_subset_stage_scope_t ()
+  {
+    if (likely (!func)) return;
+
+    info.end_ns = _hb_subset_stage_now_ns ();
+    func (&info, data);
+  }
+
+  bool enabled () const { return func; }
+
+  hb_subset_stage_func_t func;
+  void *data;
+  hb_subset_stage_info_t info;
+};
+
 
 #endif /* HB_SUBSET_PLAN_HH */
@@ -252,12 +252,15 @@ _plan_estimate_subset_table_size (hb_subset_plan_t *plan,
  * Repack the serialization buffer if any offset overflows exist.
  */
 static hb_blob_t*
-_repack (hb_tag_t tag, const hb_serialize_context_t& c)
+_repack (hb_subset_plan_t *plan, hb_tag_t tag, const hb_serialize_context_t& c)
 {
   if (!c.offset_overflow ())
     return c.copy_blob ();
 
+  hb_subset_stage_scope_t stage (plan, HB_SUBSET_STAGE_REPACK, tag);
   hb_blob_t* result = hb_resolve_overflows (c.object_graph (), tag);
+  if (stage.enabled ())
+    stage.info.bytes = hb_blob_get_length (result);
 
   if (unlikely (!result))
   {
@@ -361,7 +364,7 @@ _subset (hb_subset_plan_t *plan, hb_vector_t<char> &buf)
   }
 
   bool result = false;
-  hb_blob_t *dest_blob = _repack (tag, serializer);
+  hb_blob_t *dest_blob = _repack (plan, tag, serializer);
   if (dest_blob)
   {
     DEBUG_MSG (SUBSET, nullptr,
@@ -471,9 +474,9 @@ _dependencies_satisfied (hb_subset_plan_t *plan, hb_tag_t tag,
 }
 
 static bool
-_subset_table (hb_subset_plan_t *plan,
-	       hb_vector_t<char> &buf,
-	       hb_tag_t tag)
+_do_subset_table (hb_subset_plan_t *plan,
+		  hb_vector_t<char> &buf,
+		  hb_tag_t tag)
 {
   if (plan->no_subset_tables.has (tag)) {
     return _passthrough (plan, tag);
@@ -560,19 +563,131 @@ _subset_table (hb_subset_plan_t *plan,
   }
 }
 
-static void _attach_accelerator_data (hb_subset_plan_t* plan,
-                                      hb_face_t* face /* IN/OUT */)
+/* Total length of the tables written to the subset when subsetting tag:
+ * the table itself, and those that are written along with it.  Tables
+ * written along with another one count as zero. */
+static unsigned
+_subset_table_output_length (hb_subset_plan_t *plan, hb_tag_t tag)
 {
-  if (!plan->inprogress_accelerator) return;
+  hb_tag_t tags[3] = {tag, HB_TAG_NONE, HB_TAG_NONE};
+  switch (tag)
+  {
+  case HB_OT_TAG_glyf: tags[1] = HB_OT_TAG_loca; tags[2] = HB_OT_TAG_head; break;
+  case HB_OT_TAG_hmtx: tags[1] = HB_OT_TAG_hhea; break;
+  case HB_OT_TAG_vmtx: tags[1] = HB_OT_TAG_vhea; break;
+  case HB_OT_TAG_CBLC: tags[1] = HB_OT_TAG_CBDT; break;
+  case HB_OT_TAG_loca:
+  case HB_OT_TAG_hhea:
+  case HB_OT_TAG_vhea:
+  case HB_OT_TAG_CBDT:
+    return 0;
+  case HB_OT_TAG_head:
+    if (_is_table_present (plan->source, HB_OT_TAG_glyf) && !_should_drop_table (plan, HB_OT_TAG_glyf))
+      return 0;
+    break;
+  default: break;
+  }
 
-  // Transfer the accelerator from the plan to us.
-  hb_subset_accelerator_t* accel = plan->inprogress_accelerator;
-  plan->inprogress_accelerator = nullptr;
+  hb_lock_t l (plan->dest_lock);
+  unsigned length = 0;
+  for (hb_tag_t t : tags)
+  {
+    if (t == HB_TAG_NONE) continue;
+    hb_blob_t *blob = hb_face_reference_table (plan->dest, t);
+    length += hb_blob_get_length (blob);
+    hb_blob_destroy (blob);
+  }
+  return length;
+}
 
+static bool
+_subset_table (hb_subset_plan_t *plan,
+	       hb_vector_t<char> &buf,
+	       hb_tag_t tag)
+{
+  hb_subset_stage_scope_t stage (plan, HB_SUBSET_STAGE_TABLE, tag);
+  bool ret = _do_subset_table (plan, buf, tag);
+  if (stage.enabled ())
+    stage.info.bytes = _subset_table_output_length (plan, tag);
+  return ret;
+}
+
+struct hb_subset_table_task_t
+{
+  hb_subset_plan_t *plan;
+  hb_tag_t tag;
+  bool success;
+};
+
+static void
+_subset_table_task (unsigned index, void *task_data)
+{
+  auto &task = ((hb_subset_table_task_t *) task_data)[index];
+
+  hb_vector_t<char> buf;
+  buf.alloc (8192 - 16);
+  task.success = _subset_table (task.plan, buf, task.tag);
+}
+
+/*
+ * Subsets the pending tables in rounds: each round runs all the tables whose
+ * dependencies are satisfied concurrently, each with its own scratch buffer,
+ * and waits for them before working out the next round.
+ */
+static bool
+_subset_tables_parallel (hb_subset_plan_t *plan,
+			 hb_set_t &subsetted_tags,
+			 hb_set_t &pending_subset_tags)
+{
+  hb_vector_t<hb_subset_table_task_t> tasks;
+  while (!pending_subset_tags.is_empty ())
+  {
+    if (subsetted_tags.in_error ()
+	|| pending_subset_tags.in_error ())
+      return false;
+
+    tasks.resize (0);
+    for (hb_tag_t tag : pending_subset_tags)
+    {
+      if (!_dependencies_satisfied (plan, tag,
+				    subsetted_tags,
+				    pending_subset_tags))
+	continue;
+
+      tasks.push (hb_subset_table_task_t {plan, tag, false});
+    }
+    if (unlikely (tasks.in_error ()))
+      return false;
+
+    if (!tasks)
+    {
+      DEBUG_MSG (SUBSET, nullptr, "Table dependencies unable to be satisfied. Subset failed.");
+      return false;
+    }
+
+    for (const auto &task : tasks)
+    {
+      pending_subset_tags.del (task.tag);
+      subsetted_tags.add (task.tag);
+    }
+
+    plan->run_tasks (tasks.length, _subset_table_task, tasks.arrayZ);
+
+    for (const auto &task : tasks)
+      if (unlikely (!task.success))
+	return false;
+  }
+
+  return true;
+}
+
+static bool _attach_accelerator (hb_subset_accelerator_t* accel,
+                                 hb_face_t* face /* IN/OUT */)
+{
   if (accel->in_error ())
   {
     hb_subset_accelerator_t::destroy (accel);
-    return;
+    return false;
   }
 
   // Populate caches that need access to the final tables.
@@ -585,7 +700,23 @@ static void _attach_accelerator_data (hb_subset_plan_t* plan,
                              accel,
                              hb_subset_accelerator_t::destroy,
                              true))
+  {
     hb_subset_accelerator_t::destroy (accel);
+    return false;
+  }
+  return true;
+}
+
+static void _attach_accelerator_data (hb_subset_plan_t* plan,
+                                      hb_face_t* face /* IN/OUT */)
+{
+  if (!plan->inprogress_accelerator) return;
+
+  // Transfer the accelerator from the plan to us.
+  hb_subset_accelerator_t* accel = plan->inprogress_accelerator;
+  plan->inprogress_accelerator = nullptr;
+
+  _attach_accelerator (accel, face);
 }
 
 /**
@@ -657,6 +788,12 @@ hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan)
 
   bool success = true;
 
+  if (plan->flags & HB_SUBSET_FLAGS_PARALLEL)
+  {
+    success = _subset_tables_parallel (plan, subsetted_tags, pending_subset_tags);
+    if (unlikely (!success)) goto end;
+  }
+  else
   {
     // Grouping to deallocate buf before calling hb_face_reference (plan->dest).
 
@@ -708,3 +845,249 @@ hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan)
 end:
   return success ? hb_face_reference (plan->dest) : nullptr;
 }
+
+
+namespace OT {
+
+struct SubsetAcceleratorGroup
+{
+  bool sanitize (hb_sanitize_context_t *c) const
+  {
+    TRACE_SANITIZE (this);
+    return_trace (c->check_struct (this));
+  }
+
+  HBUINT32	startUnicode;	/* First codepoint in this group. */
+  HBUINT32	endUnicode;	/* Last codepoint in this group. */
+  HBUINT32	glyphID;	/* Glyph that startUnicode maps to; the
+				 * following codepoints map to the
+				 * following glyphs. */
+  public:
+  DEFINE_SIZE_STATIC (12);
+};
+
+/* Serialized form of a hb_subset_accelerator_t, as produced by
+ * hb_subset_preprocess_save ().  Only the data derived from the font by
+ * the preprocessing subset is stored; caches that can be filled from the
+ * preprocessed font itself are rebuilt when the data is loaded, or on
+ * first use.  The cmap mapping is stored as runs of consecutive
+ * codepoints mapped to consecutive glyphs, sorted by codepoint. */
+struct SubsetAcceleratorData
+{
+  static constexpr hb_tag_t tableTag = HB_TAG ('h','b','s','a');
+
+  enum flags_t {
+    HAS_SEAC	= 0x0001u,
+  };
+
+  bool sanitize (hb_sanitize_context_t *c) const
+  {
+    TRACE_SANITIZE (this);
+    return_trace (c->check_struct (this) &&
+		  tag == tableTag &&
+		  version.major == 1 &&
+		  groups.sanitize (c));
+  }
+
+  Tag		tag;		/* 'hbsa' */
+  FixedVersion<>version;	/* 1.0 */
+  HBUINT32	fingerprint;	/* Hash of the table directory of the
+				 * preprocessed font the data was saved for. */
+  HBUINT32	numGlyphs;	/* Number of glyphs in that font. */
+  HBUINT16	flags;		/* See flags_t. */
+  HBUINT16	reserved;	/* Set to 0. */
+  Array32Of<SubsetAcceleratorGroup>
+		groups;		/* Unicode to glyph mapping. */
+  public:
+  DEFINE_SIZE_ARRAY (24, groups);
+};
+}
+
+
+/* Identifies the font a preprocessed accelerator was saved for, from
+ * the table directory of its font file alone: the tag, checksum and
+ * length of every table, and the head checksum adjustment, which
+ * covers the whole file.  A face builder is serialized first, such that
+ * it agrees with a face loaded from the blob it serializes to. */
+static uint32_t
+_preprocessed_face_fingerprint (hb_face_t *face)
+{
+  hb_blob_t *blob = hb_sanitize_context_t ().sanitize_blob<OT::OpenTypeFontFile> (hb_face_reference_blob (face));
+  const OT::OpenTypeFontFile &ot_file = *blob->as<OT::OpenTypeFontFile> ();
+  unsigned base_offset;
+  const OT::OpenTypeFontFace &ot_face = ot_file.get_face (face->index, &base_offset);
+
+  unsigned count = ot_face.get_table_count ();
+  uint32_t h = count;
+  for (unsigned i = 0; i < count; i++)
+  {
+    const OT::TableRecord &table = ot_face.get_table (i);
+    uint32_t record[3] = {table.tag, table.checkSum, table.length};
+    h = fasthash32 (record, sizeof (record), h);
+
+    if (table.tag == HB_OT_TAG_head)
+    {
+      hb_bytes_t adjustment = blob->as_bytes ().sub_array (base_offset + table.offset + 8, 4);
+      h = fasthash32 (adjustment.arrayZ, adjustment.length, h);
+    }
+  }
+
+  hb_blob_destroy (blob);
+  return h;
+}
+
+/**
+ * hb_subset_preprocess_save:
+ * @preprocessed: a face returned by hb_subset_preprocess().
+ *
+ * Serializes the data that hb_subset_preprocess() attached to
+ * @preprocessed into a compact blob.  The blob can be stored alongside
+ * the preprocessed font data (see hb_face_reference_blob()) and passed to
+ * hb_subset_preprocess_load() later, for example in another process, to
+ * restore the data without preprocessing the font again.
+ *
+ * Return value: (transfer full): the serialized data, or the empty blob if
+ * @preprocessed has no preprocessing data attached or allocation failed.
+ *
+ * XSince: REPLACEME
+ **/
+hb_blob_t *
+hb_subset_preprocess_save (hb_face_t *preprocessed)
+{
+  const hb_subset_accelerator_t *accel = (const hb_subset_accelerator_t *)
+    hb_face_get_user_data (preprocessed, hb_subset_accelerator_t::user_data_key ());
+  if (!accel)
+    return hb_blob_get_empty ();
+
+  unsigned num_groups = 0;
+  hb_codepoint_t last_cp = HB_SET_VALUE_INVALID, last_gid = HB_MAP_VALUE_INVALID;
+  for (hb_codepoint_t cp : accel->unicodes)
+  {
+    hb_codepoint_t gid = accel->unicode_to_gid.get (cp);
+    if (last_cp == HB_SET_VALUE_INVALID || cp != last_cp + 1 || gid != last_gid + 1)
+      num_groups++;
+    last_cp = cp;
+    last_gid = gid;
+  }
+
+  unsigned size = OT::SubsetAcceleratorData::min_size +
+		  num_groups * OT::SubsetAcceleratorGroup::static_size;
+  char *buf = (char *) hb_calloc (size, 1);
+  if (unlikely (!buf))
+    return hb_blob_get_empty ();
+
+  OT::SubsetAcceleratorData *data = (OT::SubsetAcceleratorData *) buf;
+  data->tag = OT::SubsetAcceleratorData::tableTag;
+  data->version.major = 1;
+  data->version.minor = 0;
+  data->fingerprint = _preprocessed_face_fingerprint (preprocessed);
+  data->numGlyphs = preprocessed->get_num_glyphs ();
+  data->flags = accel->has_seac ? OT::SubsetAcceleratorData::HAS_SEAC : 0;
+  data->groups.len = num_groups;
+
+  OT::SubsetAcceleratorGroup *group = nullptr;
+  last_cp = HB_SET_VALUE_INVALID;
+  last_gid = HB_MAP_VALUE_INVALID;
+  for (hb_codepoint_t cp : accel->unicodes)
+  {
+    hb_codepoint_t gid = accel->unicode_to_gid.get (cp);
+    if (last_cp == HB_SET_VALUE_INVALID || cp != last_cp + 1 || gid != last_gid + 1)
+    {
+      group = group ? group + 1 : data->groups.arrayZ;
+      group->startUnicode = cp;
+      group->glyphID = gid;
+    }
+    group->endUnicode = cp;
+    last_cp = cp;
+    last_gid = gid;
+  }
+
+  return hb_blob_create (buf, size, HB_MEMORY_MODE_WRITABLE, buf, hb_free);
+}
+
+static hb_blob_t *
+_reference_preprocessed_table (hb_face_t *face HB_UNUSED, hb_tag_t tag, void *user_data)
+{
+  return hb_face_reference_table ((hb_face_t *) user_data, tag);
+}
+
+/**
+ * hb_subset_preprocess_load:
+ * @face: a face created from the data of a preprocessed face.
+ * @data: the blob returned by hb_subset_preprocess_save() for that
+ * preprocessed face.
+ *
+ * Attaches the preprocessing data serialized in @data to @face, after
+ * which subsetting @face is as fast as subsetting the face returned by
+ * hb_subset_preprocess().  @data is typically loaded with
+ * hb_blob_create_from_file(), which maps the file into memory where
+ * possible; the Unicode to glyph mapping in it is copied into @face,
+ * and @data is not retained.
+ *
+ * @data is checked against the table directory of @face, and is rejected
+ * if it was saved for a different font.  Caches which are not serialized, such
+ * as those for CFF charstrings, are rebuilt on first use.
+ *
+ * Return value: `true` if the data was attached to @face, `false` otherwise.
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_subset_preprocess_load (hb_face_t *face,
+			   hb_blob_t *data)
+{
+  hb_blob_ptr_t<OT::SubsetAcceleratorData> data_ptr (
+    hb_sanitize_context_t ().sanitize_blob<OT::SubsetAcceleratorData> (hb_blob_reference (data)));
+  const OT::SubsetAcceleratorData *table = data_ptr.get ();
+
+  unsigned num_glyphs = face->get_num_glyphs ();
+  if (!data_ptr.get_length () ||
+      table->numGlyphs != num_glyphs ||
+      table->fingerprint != _preprocessed_face_fingerprint (face))
+  {
+    DEBUG_MSG (SUBSET, nullptr, "Preprocessed data does not match face.");
+    data_ptr.destroy ();
+    return false;
+  }
+
+  hb_map_t unicode_to_gid;
+  hb_set_t unicodes;
+  hb_codepoint_t next_cp = 0;
+  bool success = true;
+  for (const auto &group : table->groups)
+  {
+    hb_codepoint_t start = group.startUnicode;
+    hb_codepoint_t end = group.endUnicode;
+    hb_codepoint_t gid = group.glyphID;
+    if (unlikely (start < next_cp || start > end || end > HB_UNICODE_MAX ||
+		  gid >= num_glyphs || end - start >= num_glyphs - gid))
+    {
+      success = false;
+      break;
+    }
+    next_cp = end + 1;
+
+    unicodes.add_range (start, end);
+    for (hb_codepoint_t cp = start; cp <= end; cp++)
+      unicode_to_gid.set (cp, gid++);
+  }
+  bool has_seac = table->flags & OT::SubsetAcceleratorData::HAS_SEAC;
+  data_ptr.destroy ();
+
+  if (unlikely (!success || unicodes.in_error () || unicode_to_gid.in_error ()))
+    return false;
+
+  /* The accelerator holds a reference to its source face, so it cannot
+   * refer to the face it is attached to directly.  Give it a face that
+   * forwards to that one instead; it never outlives it. */
+  hb_face_t *source = hb_face_create_for_tables (_reference_preprocessed_table, face, nullptr);
+  hb_subset_accelerator_t *accel = hb_subset_accelerator_t::create (source,
+								    unicode_to_gid,
+								    unicodes,
+								    has_seac);
+  hb_face_destroy (source);
+  if (unlikely (!accel))
+    return false;
+
+  return _attach_accelerator (accel, face);
+}
@@ -78,6 +78,13 @@ typedef struct hb_subset_plan_t hb_subset_plan_t;
  * @HB_SUBSET_FLAGS_IFTB_REQUIREMENTS: If set enforce requirements on the output subset
  * to allow it to be used with incremental font transfer IFTB patches. Primarily,
  * this forces all outline data to use long (32 bit) offsets. Since: EXPERIMENTAL
+ * @HB_SUBSET_FLAGS_PARALLEL: If set tables that do not depend on each other are
+ * subset concurrently, using the executor set with hb_subset_input_set_executor().
+ * If none is set, the calling thread and a small pool of short-lived threads
+ * (eight threads in total by default) take tables in turn.  When instancing,
+ * the glyphs of `gvar` are also split in ranges.  A set executor may process
+ * those concurrently too; without one they are processed in turn on the thread
+ * subsetting `gvar`. XSince: REPLACEME
  *
  * List of boolean properties that can be configured on the subset input.
  *
@@ -99,6 +106,7 @@ typedef enum { /*< flags >*/
 #ifdef HB_EXPERIMENTAL_API
   HB_SUBSET_FLAGS_IFTB_REQUIREMENTS       =  0x00000800u,
 #endif
+  HB_SUBSET_FLAGS_PARALLEL                =  0x00001000u,
 } hb_subset_flags_t;
 
 /**
@@ -131,6 +139,119 @@ typedef enum {
   HB_SUBSET_SETS_LAYOUT_SCRIPT_TAG,
 } hb_subset_sets_t;
 
+/**
+ * hb_subset_task_func_t:
+ * @index: index of the task to run
+ * @task_data: data passed to the executor along with this function
+ *
+ * A function that performs one of the tasks handed to a
+ * #hb_subset_executor_func_t.
+ *
+ * XSince: REPLACEME
+ **/
+typedef void (*hb_subset_task_func_t) (unsigned int  index,
+				       void         *task_data);
+
+/**
+ * hb_subset_executor_func_t:
+ * @num_tasks: number of tasks to run
+ * @task: function that runs a task
+ * @task_data: data to pass to @task
+ * @user_data: user data passed to hb_subset_input_set_executor()
+ *
+ * A function that runs `task (i, task_data)` for each `i` from zero to
+ * @num_tasks - 1, and returns once all of them have finished.  The tasks
+ * are independent of each other and may be run in any order, on any
+ * number of threads.  Typically this hands the tasks to a thread pool.
+ *
+ * A task may itself call the executor to split up its work, for example
+ * to instance the glyphs of a `gvar` table in ranges.  An executor backed
+ * by a fixed-size pool must not deadlock then; it can, for instance, run
+ * the nested tasks on the calling thread.
+ *
+ * XSince: REPLACEME
+ **/
+typedef void (*hb_subset_executor_func_t) (unsigned int           num_tasks,
+					   hb_subset_task_func_t  task,
+					   void                  *task_data,
+					   void                  *user_data);
+
+/**
+ * hb_subset_stage_t:
+ * @HB_SUBSET_STAGE_PLAN: Creating the subset plan.  Encloses the closure
+ * stages.
+ * @HB_SUBSET_STAGE_GLYPH_CLOSURE: Computing the set of glyphs to retain.
+ * Encloses the layout and COLR closure stages.
+ * @HB_SUBSET_STAGE_LAYOUT_CLOSURE: Closing over the lookups and features of
+ * the GSUB or GPOS table.
+ * @HB_SUBSET_STAGE_COLR_CLOSURE: Adding the glyphs referenced by the COLR
+ * table.
+ * @HB_SUBSET_STAGE_TABLE: Subsetting a table.  Encloses the repack stage.
+ * @HB_SUBSET_STAGE_REPACK: Resolving offset overflows in a subset table with
+ * the repacker.
+ *
+ * The stages of a subsetting operation reported to a
+ * #hb_subset_stage_func_t.
+ *
+ * XSince: REPLACEME
+ **/
+typedef enum {
+  HB_SUBSET_STAGE_PLAN,
+  HB_SUBSET_STAGE_GLYPH_CLOSURE,
+  HB_SUBSET_STAGE_LAYOUT_CLOSURE,
+  HB_SUBSET_STAGE_COLR_CLOSURE,
+  HB_SUBSET_STAGE_TABLE,
+  HB_SUBSET_STAGE_REPACK,
+} hb_subset_stage_t;
+
+/**
+ * hb_subset_stage_info_t:
+ * @stage: the stage
+ * @table_tag: the table the stage works on, or `HB_TAG_NONE`
+ * @start_ns: when the stage started, in nanoseconds of a monotonic clock
+ * @end_ns: when the stage ended, or zero while it is starting
+ * @bytes: for table and repack stages that have ended, the number of bytes
+ * they added to the subset font
+ *
+ * Describes a stage of a subsetting operation.
+ *
+ * XSince: REPLACEME
+ **/
+typedef struct hb_subset_stage_info_t
+{
+  hb_subset_stage_t stage;
+  hb_tag_t          table_tag;
+  uint64_t          start_ns;
+  uint64_t          end_ns;
+  unsigned int      bytes;
+
+  /*< private >*/
+  unsigned int      reserved1;
+  unsigned int      reserved2;
+  unsigned int      reserved3;
+} hb_subset_stage_info_t;
+
+/**
+ * hb_subset_stage_func_t:
+ * @info: the stage that is starting or ending
+ * @user_data: user data passed to hb_subset_input_set_stage_func()
+ *
+ * A function called when each stage of a subsetting operation starts,
+ * with @info's end_ns field set to zero, and again when it ends.
+ *
+ * Stages nest as described in #hb_subset_stage_t; table stages do not
+ * nest in each other.  With #HB_SUBSET_FLAGS_PARALLEL, table stages may
+ * be reported concurrently from several threads.
+ *
+ * Since the function is called on the thread doing the work, at the
+ * start and end of each stage, it can also attribute other resources,
+ * such as allocations made with a custom allocator, to the stage.
+ *
+ * XSince: REPLACEME
+ **/
+typedef void (*hb_subset_stage_func_t) (const hb_subset_stage_info_t *info,
+					void                         *user_data);
+
 HB_EXTERN hb_subset_input_t *
 hb_subset_input_create_or_fail (void);
 
@@ -173,6 +294,16 @@ HB_EXTERN void
 hb_subset_input_set_flags (hb_subset_input_t *input,
 			   unsigned value);
 
+HB_EXTERN void
+hb_subset_input_set_executor (hb_subset_input_t         *input,
+			      hb_subset_executor_func_t  func,
+			      void                      *user_data);
+
+HB_EXTERN void
+hb_subset_input_set_stage_func (hb_subset_input_t      *input,
+				hb_subset_stage_func_t  func,
+				void                   *user_data);
+
 HB_EXTERN hb_bool_t
 hb_subset_input_pin_all_axes_to_default (hb_subset_input_t  *input,
 					 hb_face_t          *face);
@@ -217,6 +348,13 @@ hb_subset_input_override_name_table (hb_subset_input_t  *input,
 HB_EXTERN hb_face_t *
 hb_subset_preprocess (hb_face_t *source);
 
+HB_EXTERN hb_blob_t *
+hb_subset_preprocess_save (hb_face_t *preprocessed);
+
+HB_EXTERN hb_bool_t
+hb_subset_preprocess_load (hb_face_t *face,
+			   hb_blob_t *data);
+
 HB_EXTERN hb_face_t *
 hb_subset_or_fail (hb_face_t *source, const hb_subset_input_t *input);
 
@@ -227,6 +365,11 @@ HB_EXTERN hb_subset_plan_t *
 hb_subset_plan_create_or_fail (hb_face_t                 *face,
                                const hb_subset_input_t   *input);
 
+HB_EXTERN hb_subset_plan_t *
+hb_subset_plan_create_incremental_or_fail (hb_face_t               *face,
+					   const hb_subset_input_t *input,
+					   const hb_subset_plan_t  *previous);
+
 HB_EXTERN void
 hb_subset_plan_destroy (hb_subset_plan_t *plan);
 
@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+#include "hb-cache.hh"
+
+
+int
+main (int argc, char **argv)
+{
+  /* Direct-mapped cache. */
+  {
+    hb_cache_t<16, 16, 8, false> c;
+    unsigned v;
+    assert (!c.get (1, &v));
+    assert (c.set (1, 100));
+    assert (c.get (1, &v) && v == 100);
+    assert (c.set (1 + 256, 200)); /* Same slot; evicts. */
+    assert (!c.get (1, &v));
+    assert (c.get (1 + 256, &v) && v == 200);
+    assert (!c.set (1u << 16, 0));
+  }
+
+  /* Set-associative cache. */
+  {
+    using cache_t = hb_set_assoc_cache_t<21, 16, 4, true>;
+    cache_t *c = cache_t::create (6);
+    assert (c);
+    assert (c->get_population () == 4 << 6);
+
+    unsigned v;
+    assert (!c->get (0x4E00, &v));
+
+    /* Four keys mapping to the same set all stay cached. */
+    for (unsigned i = 0; i < 4; i++)
+      assert (c->set (0x4E00 + (i << 6), i + 1));
+    for (unsigned i = 0; i < 4; i++)
+      assert (c->get (0x4E00 + (i << 6), &v) && v == i + 1);
+
+    /* Hits do not reorder a thread-safe cache, so a fifth evicts the
+     * first inserted. */
+    unsigned hits, misses;
+    c->get_stats (&hits, &misses);
+    assert (hits == 4 && misses == 1);
+    for (unsigned j = 0; j < 3; j++)
+      assert (c->get (0x4E00, &v) && v == 1);
+    assert (c->set (0x4E00 + (4 << 6), 5));
+    assert (!c->get (0x4E00, &v));
+    assert (c->get (0x4E00 + (4 << 6), &v) && v == 5);
+    c->get_stats (&hits, &misses);
+    assert (hits == 8 && misses == 2);
+
+    /* Overflowing keys and values are neither stored nor matched. */
+    assert (!c->set (1u << 21, 0));
+    assert (!c->set (0, 1u << 16));
+    assert (!c->get (0xFFFFu << 6, &v));
+    assert (!c->get (~0u, &v));
+
+    c->clear ();
+    assert (!c->get (0x4E00, &v));
+
+    cache_t::destroy (c);
+  }
+
+  /* The thread-unsafe cache moves hit items towards the front, so a
+   * fifth evicts the least-recently-used one instead. */
+  {
+    using cache_t = hb_set_assoc_cache_t<21, 16, 4, false>;
+    cache_t *c = cache_t::create (6);
+    assert (c);
+
+    unsigned v;
+    for (unsigned i = 0; i < 4; i++)
+      assert (c->set (0x4E00 + (i << 6), i + 1));
+    for (unsigned j = 0; j < 3; j++)
+      assert (c->get (0x4E00, &v) && v == 1);
+    assert (c->set (0x4E00 + (4 << 6), 5));
+    assert (c->get (0x4E00, &v) && v == 1);
+    assert (c->get (0x4E00 + (4 << 6), &v) && v == 5);
+    unsigned cached = 0;
+    for (unsigned i = 0; i < 5; i++)
+      cached += c->get (0x4E00 + (i << 6), &v);
+    assert (cached == 4);
+
+    cache_t::destroy (c);
+  }
+
+  /* The number of sets is raised to fit tag and value in an item. */
+  {
+    using cache_t = hb_set_assoc_cache_t<24, 16, 2, false>;
+    cache_t *c = cache_t::create (0);
+    assert (c);
+    assert (c->get_population () == 2 << 9);
+
+    unsigned v;
+    assert (c->set (0xFFFFFF, 0xFFFF));
+    assert (c->get (0xFFFFFF, &v) && v == 0xFFFF);
+    assert (!c->get (0xFFFFFF - (1 << 9), &v));
+
+    cache_t::destroy (c);
+  }
+
+  return 0;
+}
@@ -1602,6 +1602,55 @@ static void test_sort_shortest ()
   free (buffer);
 }
 
+static void assert_same_order (const graph_t& a, const graph_t& b)
+{
+  assert (a.vertices_.length == b.vertices_.length);
+  for (unsigned i = 0; i < a.vertices_.length; i++)
+  {
+    const auto& obj_a = a.object (i);
+    const auto& obj_b = b.object (i);
+    assert (obj_a.head == obj_b.head);
+    assert (obj_a.real_links.length == obj_b.real_links.length);
+    for (unsigned j = 0; j < obj_a.real_links.length; j++)
+      assert (obj_a.real_links[j].objidx == obj_b.real_links[j].objidx);
+  }
+}
+
+static void test_sort_shortest_incremental ()
+{
+  size_t buffer_size = 100;
+  void* buffer = malloc (buffer_size);
+  hb_serialize_context_t c (buffer, buffer_size);
+  populate_serializer_complex_3 (&c);
+
+  graph_t full (c.object_graph ());
+  graph_t incremental (c.object_graph ());
+  full.sort_shortest_distance ();
+  incremental.sort_shortest_distance ();
+  assert_same_order (full, incremental);
+
+  // "jkl" is shared by "abc" and "ghi".
+  assert (strncmp (full.object (1).head, "jkl", 3) == 0);
+  assert (full.vertices_[1].is_shared ());
+  assert (strncmp (full.object (2).head, "ghi", 3) == 0);
+
+  full.duplicate (2, 1);
+  full.sort_shortest_distance ();
+  incremental.duplicate (2, 1);
+  incremental.sort_shortest_distance_incremental ();
+  assert (!incremental.in_error ());
+  assert_same_order (full, incremental);
+
+  full.raise_childrens_priority (full.root_idx ());
+  full.sort_shortest_distance ();
+  incremental.raise_childrens_priority (incremental.root_idx ());
+  incremental.sort_shortest_distance_incremental ();
+  assert (!incremental.in_error ());
+  assert_same_order (full, incremental);
+
+  free (buffer);
+}
+
 static void test_duplicate_leaf ()
 {
   size_t buffer_size = 100;
@@ -2265,6 +2314,7 @@ main (int argc, char **argv)
 {
   test_serialize ();
   test_sort_shortest ();
+  test_sort_shortest_incremental ();
   test_will_overflow_1 ();
   test_will_overflow_2 ();
   test_will_overflow_3 ();
@@ -265,6 +265,11 @@ test_hb_draw_cff1 (void)
 		    "M300,653L342,694L201,861L143,806L300,653Z";
   g_assert_cmpmem (str, draw_data.consumed, expected, sizeof (expected) - 1);
 
+  /* Again, from the decoded charstrings. */
+  draw_data.consumed = 0;
+  hb_font_draw_glyph (font, 3, funcs, &draw_data);
+  g_assert_cmpmem (str, draw_data.consumed, expected, sizeof (expected) - 1);
+
   hb_font_destroy (font);
 }
 
@@ -329,6 +334,12 @@ test_hb_draw_cff2 (void)
 		     "C423,107 390,86 344,86C262,86 209,148 209,261C209,398 271,448 323,448Z";
   g_assert_cmpmem (str, draw_data.consumed, expected2, sizeof (expected2) - 1);
 
+  /* Glyph 3 was decoded at the default instance; blends are redone. */
+  hb_font_set_variations (font, NULL, 0);
+  draw_data.consumed = 0;
+  hb_font_draw_glyph (font, 3, funcs, &draw_data);
+  g_assert_cmpmem (str, draw_data.consumed, expected, sizeof (expected) - 1);
+
   hb_font_destroy (font);
 }
 
@@ -1064,6 +1075,72 @@ test_hb_draw_subfont_scale (void)
   }
 }
 
+static void
+test_hb_draw_outline_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *cached_font = hb_font_create (face);
+  hb_face_destroy (face);
+  hb_font_set_outline_cache_size (cached_font, 1 << 20);
+
+  char str[1024], cached_str[1024];
+  draw_data_t draw_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  draw_data_t cached_draw_data = {
+    .str = cached_str,
+    .size = sizeof (cached_str)
+  };
+
+  hb_variation_t var;
+  var.tag = HB_TAG ('w','g','h','t');
+  unsigned hits, misses, evictions, bytes;
+  for (unsigned i = 0; i < 2; i++)
+  {
+    var.value = i ? 800 : 400;
+    hb_font_set_variations (font, &var, 1);
+    hb_font_set_variations (cached_font, &var, 1);
+
+    for (unsigned j = 0; j < 2; j++)
+    {
+      hb_draw_funcs_t *dfuncs = j ? funcs2 : funcs;
+
+      draw_data.consumed = 0;
+      hb_font_draw_glyph (font, 3, dfuncs, &draw_data);
+      cached_draw_data.consumed = 0;
+      hb_font_draw_glyph (cached_font, 3, dfuncs, &cached_draw_data);
+      g_assert_cmpmem (str, draw_data.consumed, cached_str, cached_draw_data.consumed);
+    }
+  }
+
+  /* One miss per set of coords; the second draw replays the first. */
+  hb_font_get_outline_cache_stats (cached_font, &hits, &misses, &evictions, &bytes);
+  g_assert_cmpuint (hits, ==, 2);
+  g_assert_cmpuint (misses, ==, 2);
+  g_assert_cmpuint (evictions, ==, 0);
+  g_assert_cmpuint (bytes, >, 0);
+
+  /* Nothing fits in a tiny budget. */
+  hb_font_set_outline_cache_size (cached_font, 16);
+  hb_font_get_outline_cache_stats (cached_font, NULL, NULL, &evictions, &bytes);
+  g_assert_cmpuint (evictions, ==, 1);
+  g_assert_cmpuint (bytes, ==, 0);
+  cached_draw_data.consumed = 0;
+  hb_font_draw_glyph (cached_font, 3, funcs, &cached_draw_data);
+  hb_font_get_outline_cache_stats (cached_font, NULL, NULL, NULL, &bytes);
+  g_assert_cmpuint (bytes, ==, 0);
+
+  hb_font_set_outline_cache_size (cached_font, 0);
+  hb_font_get_outline_cache_stats (cached_font, &hits, &misses, NULL, NULL);
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  hb_font_destroy (cached_font);
+  hb_font_destroy (font);
+}
+
 static void
 test_hb_draw_immutable (void)
 {
@@ -1190,6 +1267,7 @@ main (int argc, char **argv)
   hb_test_add (test_hb_draw_drawing_funcs);
   hb_test_add (test_hb_draw_synthetic_slant);
   hb_test_add (test_hb_draw_subfont_scale);
+  hb_test_add (test_hb_draw_outline_cache);
   hb_test_add (test_hb_draw_immutable);
 #ifdef HAVE_FREETYPE
   hb_test_add (test_hb_draw_ft);
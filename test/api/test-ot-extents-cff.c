@@ -152,6 +152,54 @@ test_extents_cff2 (void)
   hb_font_destroy (font);
 }
 
+static void
+test_extents_cff2_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype.abc.otf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+
+  /* Repeated queries are served from the extents cache; any change
+   * to the font must invalidate it. */
+  hb_glyph_extents_t  extents;
+  unsigned int i;
+  for (i = 0; i < 2; i++)
+  {
+    g_assert (hb_font_get_glyph_extents (font, 1, &extents));
+    g_assert_cmpint (extents.x_bearing, ==, 46);
+    g_assert_cmpint (extents.y_bearing, ==, 487);
+    g_assert_cmpint (extents.width, ==, 455);
+    g_assert_cmpint (extents.height, ==, -500);
+  }
+
+  float coords[2] = { 600.0f, 50.0f };
+  hb_font_set_var_coords_design (font, coords, 2);
+  for (i = 0; i < 2; i++)
+  {
+    g_assert (hb_font_get_glyph_extents (font, 1, &extents));
+    g_assert_cmpint (extents.x_bearing, ==, 38);
+    g_assert_cmpint (extents.y_bearing, ==, 493);
+    g_assert_cmpint (extents.width, ==, 480);
+    g_assert_cmpint (extents.height, ==, -507);
+  }
+
+  hb_font_set_var_coords_design (font, NULL, 0);
+  hb_font_set_scale (font, 2000, 2000);
+  for (i = 0; i < 2; i++)
+  {
+    g_assert (hb_font_get_glyph_extents (font, 1, &extents));
+    g_assert_cmpint (extents.x_bearing, ==, 92);
+    g_assert_cmpint (extents.y_bearing, ==, 974);
+    g_assert_cmpint (extents.width, ==, 910);
+    g_assert_cmpint (extents.height, ==, -1000);
+  }
+
+  hb_font_destroy (font);
+}
+
 static void
 test_extents_cff2_vsindex (void)
 {
@@ -224,6 +272,7 @@ main (int argc, char **argv)
   hb_test_add (test_extents_cff1_flex);
   hb_test_add (test_extents_cff1_seac);
   hb_test_add (test_extents_cff2);
+  hb_test_add (test_extents_cff2_cache);
   hb_test_add (test_extents_cff2_vsindex);
   hb_test_add (test_extents_cff2_vsindex_named_instance);
 
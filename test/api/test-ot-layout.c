@@ -215,6 +215,65 @@ test_ot_layout_language_get_feature_tags (void)
   hb_face_destroy (face);
 }
 
+/* The GSUB tables of these fonts are 64kb, so their lookups are sanitized
+ * lazily, as they are first used.  Each substitutes glyph 1. */
+
+static void
+test_ot_layout_lazy_lookup_sane (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/gsub-lazy-lookup-edits.otf");
+  hb_codepoint_t glyph = 1;
+
+  g_assert_cmpuint (2, ==, hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB));
+  g_assert_true (hb_ot_layout_lookup_would_substitute (face, 1, &glyph, 1, TRUE));
+
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_layout_lazy_lookup_edits (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/gsub-lazy-lookup-edits.otf");
+  hb_codepoint_t glyph = 1;
+
+  /* The subtable offset of lookup 0 points past the end of the table, at a
+   * well-formed subtable in the bytes following it in the file.  Sanitizing
+   * drops the offset, so that subtable must never be used. */
+  g_assert_false (hb_ot_layout_lookup_would_substitute (face, 0, &glyph, 1, TRUE));
+
+  hb_set_t *glyphs_input = hb_set_create ();
+  hb_ot_layout_lookup_collect_glyphs (face, HB_OT_TAG_GSUB, 0, NULL, glyphs_input, NULL, NULL);
+  g_assert_true (hb_set_is_empty (glyphs_input));
+  hb_set_destroy (glyphs_input);
+
+  /* Lookup 1 is still used from the table itself. */
+  g_assert_true (hb_ot_layout_lookup_would_substitute (face, 1, &glyph, 1, TRUE));
+
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_layout_lazy_lookup_budget (void)
+{
+  hb_face_t *face;
+  hb_codepoint_t glyph = 1;
+  unsigned int i;
+
+  /* Five lookups of 4000 subtables each: every lookup fits the sanitizer's
+   * subtable budget on its own, but not all of them together.  No lookup
+   * applies, whichever order they are first used in. */
+  face = hb_test_open_font_file ("fonts/gsub-lazy-lookup-budget.otf");
+  g_assert_cmpuint (5, ==, hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB));
+  for (i = 0; i < 5; i++)
+    g_assert_false (hb_ot_layout_lookup_would_substitute (face, i, &glyph, 1, TRUE));
+  hb_face_destroy (face);
+
+  face = hb_test_open_font_file ("fonts/gsub-lazy-lookup-budget.otf");
+  for (i = 5; i; i--)
+    g_assert_false (hb_ot_layout_lookup_would_substitute (face, i - 1, &glyph, 1, TRUE));
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -224,5 +283,8 @@ main (int argc, char **argv)
   hb_test_add (test_ot_layout_script_get_language_tags);
   hb_test_add (test_ot_layout_table_get_feature_tags);
   hb_test_add (test_ot_layout_language_get_feature_tags);
+  hb_test_add (test_ot_layout_lazy_lookup_sane);
+  hb_test_add (test_ot_layout_lazy_lookup_edits);
+  hb_test_add (test_ot_layout_lazy_lookup_budget);
   return hb_test_run ();
 }
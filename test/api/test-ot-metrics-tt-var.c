@@ -133,6 +133,93 @@ test_advance_tt_var_hvarvvar (void)
   hb_font_destroy (font);
 }
 
+static void
+test_advance_tt_var_hvarvvar_coords_change (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+
+  hb_ot_var_axis_info_t axis;
+  unsigned count = 1;
+  hb_ot_var_get_axis_infos (face, 0, &count, &axis);
+  hb_face_destroy (face);
+  g_assert_cmpint (count, ==, 1);
+
+  /* The variation store caches kept on the font must not outlive the
+   * coords they were computed for. */
+  float coords[1] = { 700.0f };
+  for (unsigned i = 0; i < 2; i++)
+  {
+    hb_position_t x, y;
+
+    coords[0] = 700.0f;
+    hb_font_set_var_coords_design (font, coords, 1);
+    hb_font_get_glyph_advance_for_direction(font, 1, HB_DIRECTION_LTR, &x, &y);
+    g_assert_cmpint (x, ==, 531);
+    hb_font_get_glyph_advance_for_direction(font, 1, HB_DIRECTION_TTB, &x, &y);
+    g_assert_cmpint (y, ==, -1012);
+
+    coords[0] = axis.default_value;
+    hb_font_set_var_coords_design (font, coords, 1);
+    hb_font_get_glyph_advance_for_direction(font, 1, HB_DIRECTION_LTR, &x, &y);
+    g_assert_cmpint (x, ==, 508);
+    hb_font_get_glyph_advance_for_direction(font, 1, HB_DIRECTION_TTB, &x, &y);
+    g_assert_cmpint (y, ==, -1000);
+  }
+
+  hb_font_destroy (font);
+}
+
+static void
+test_ot_font_cache_stats (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+
+  unsigned cmap_hits, cmap_misses, advance_hits, advance_misses;
+  hb_codepoint_t gid;
+  g_assert (hb_font_get_nominal_glyph (font, 'b', &gid));
+
+  g_assert (hb_ot_font_get_cache_stats (font, &cmap_hits, &cmap_misses, &advance_hits, &advance_misses));
+  g_assert_cmpuint (cmap_hits, ==, 0);
+  g_assert_cmpuint (cmap_misses, ==, 1);
+  g_assert_cmpuint (advance_hits, ==, 0);
+  g_assert_cmpuint (advance_misses, ==, 0);
+
+  float coords[1] = { 700.0f };
+  hb_font_set_var_coords_design (font, coords, 1);
+  for (unsigned i = 0; i < 3; i++)
+  {
+    g_assert (hb_font_get_nominal_glyph (font, 'a', &gid));
+    g_assert_cmpint (hb_font_get_glyph_h_advance (font, gid), ==, 531);
+  }
+
+  g_assert (hb_ot_font_get_cache_stats (font, &cmap_hits, &cmap_misses, &advance_hits, &advance_misses));
+  g_assert_cmpuint (cmap_hits, ==, 2);
+  g_assert_cmpuint (cmap_misses, ==, 2);
+  g_assert_cmpuint (advance_hits, ==, 2);
+  g_assert_cmpuint (advance_misses, ==, 1);
+
+  /* Stats are not available for other font functions. */
+  hb_font_t *sub_font = hb_font_create_sub_font (font);
+  g_assert (!hb_ot_font_get_cache_stats (sub_font, &cmap_hits, &cmap_misses, &advance_hits, &advance_misses));
+  g_assert_cmpuint (cmap_hits, ==, 0);
+  g_assert_cmpuint (cmap_misses, ==, 0);
+  g_assert_cmpuint (advance_hits, ==, 0);
+  g_assert_cmpuint (advance_misses, ==, 0);
+  g_assert (!hb_ot_font_get_cache_stats (hb_font_get_empty (), NULL, NULL, NULL, NULL));
+
+  hb_font_destroy (sub_font);
+  hb_font_destroy (font);
+}
+
 static void
 test_advance_tt_var_anchor (void)
 {
@@ -251,6 +338,84 @@ test_advance_tt_var_gvar_infer (void)
   hb_font_destroy (font);
 }
 
+static hb_font_t *
+create_font_with_coords (hb_face_t *face, const int *coords, unsigned count)
+{
+  hb_font_t *font = hb_font_create (face);
+  hb_ot_font_set_funcs (font);
+  hb_font_set_var_coords_normalized (font, coords, count);
+  return font;
+}
+
+/* The variation store caches kept on the font belong to its face, and
+ * must not be used with the stores of a face set on it later. */
+static void
+test_var_store_caches_set_face (void)
+{
+  const int coords[2] = {-8192, 12288};
+
+  /* MVAR; Estedad has three regions in its store, Mada two. */
+  const char *mvar_fonts[] = {"fonts/Estedad-VF.ttf", "fonts/Mada-VF.ttf"};
+  for (unsigned order = 0; order < 2; order++)
+  {
+    hb_face_t *face1 = hb_test_open_font_file (mvar_fonts[order]);
+    hb_face_t *face2 = hb_test_open_font_file (mvar_fonts[1 - order]);
+    hb_font_t *font = create_font_with_coords (face1, coords, 2);
+    hb_font_t *expected = create_font_with_coords (face2, coords, 2);
+
+    hb_ot_metrics_tag_t tags[] = {HB_OT_METRICS_TAG_STRIKEOUT_SIZE,
+				  HB_OT_METRICS_TAG_UNDERLINE_SIZE,
+				  HB_OT_METRICS_TAG_HORIZONTAL_CLIPPING_ASCENT,
+				  HB_OT_METRICS_TAG_HORIZONTAL_CLIPPING_DESCENT,
+				  HB_OT_METRICS_TAG_STRIKEOUT_OFFSET,
+				  HB_OT_METRICS_TAG_X_HEIGHT};
+    for (unsigned i = 0; i < G_N_ELEMENTS (tags); i++)
+      (void) hb_ot_metrics_get_variation (font, tags[i]);
+
+    hb_font_set_face (font, face2);
+    for (unsigned i = 0; i < G_N_ELEMENTS (tags); i++)
+      g_assert_cmpfloat (hb_ot_metrics_get_variation (font, tags[i]), ==,
+			 hb_ot_metrics_get_variation (expected, tags[i]));
+
+    hb_font_destroy (expected);
+    hb_font_destroy (font);
+    hb_face_destroy (face2);
+    hb_face_destroy (face1);
+  }
+
+  /* CFF2 */
+  {
+    hb_face_t *face1 = hb_test_open_font_file ("fonts/AdobeVFPrototype-Subset.otf");
+    hb_face_t *face2 = hb_test_open_font_file ("fonts/TestCFF2VF.otf");
+    hb_font_t *font = create_font_with_coords (face1, coords, 2);
+    hb_font_t *expected = create_font_with_coords (face2, coords, 2);
+
+    hb_glyph_extents_t extents;
+    for (hb_codepoint_t gid = 0; gid < 4; gid++)
+      (void) hb_font_get_glyph_extents (font, gid, &extents);
+
+    /* The ot font funcs hold on to the face they were set up for. */
+    hb_font_set_face (font, face2);
+    hb_ot_font_set_funcs (font);
+    unsigned num_glyphs = hb_face_get_glyph_count (face2);
+    for (hb_codepoint_t gid = 0; gid < num_glyphs; gid++)
+    {
+      hb_glyph_extents_t expected_extents;
+      g_assert_cmpint (hb_font_get_glyph_extents (font, gid, &extents), ==,
+		       hb_font_get_glyph_extents (expected, gid, &expected_extents));
+      g_assert_cmpint (extents.x_bearing, ==, expected_extents.x_bearing);
+      g_assert_cmpint (extents.y_bearing, ==, expected_extents.y_bearing);
+      g_assert_cmpint (extents.width, ==, expected_extents.width);
+      g_assert_cmpint (extents.height, ==, expected_extents.height);
+    }
+
+    hb_font_destroy (expected);
+    hb_font_destroy (font);
+    hb_face_destroy (face2);
+    hb_face_destroy (face1);
+  }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -259,6 +424,9 @@ main (int argc, char **argv)
   hb_test_add (test_extents_tt_var);
   hb_test_add (test_advance_tt_var_nohvar);
   hb_test_add (test_advance_tt_var_hvarvvar);
+  hb_test_add (test_advance_tt_var_hvarvvar_coords_change);
+  hb_test_add (test_var_store_caches_set_face);
+  hb_test_add (test_ot_font_cache_stats);
   hb_test_add (test_advance_tt_var_anchor);
   hb_test_add (test_extents_tt_var_comp);
   hb_test_add (test_advance_tt_var_comp_v);
@@ -179,6 +179,250 @@ test_shape_clusters (void)
   hb_font_destroy (font);
 }
 
+static void
+assert_buffers_equal (hb_buffer_t *a, hb_buffer_t *b)
+{
+  unsigned int len_a, len_b, i;
+  hb_glyph_info_t *info_a = hb_buffer_get_glyph_infos (a, &len_a);
+  hb_glyph_info_t *info_b = hb_buffer_get_glyph_infos (b, &len_b);
+  hb_glyph_position_t *pos_a = hb_buffer_get_glyph_positions (a, NULL);
+  hb_glyph_position_t *pos_b = hb_buffer_get_glyph_positions (b, NULL);
+
+  g_assert_cmpint (hb_buffer_get_content_type (a), ==, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+  g_assert_cmpint (len_a, ==, len_b);
+  for (i = 0; i < len_a; i++)
+  {
+    g_assert_cmphex (info_a[i].codepoint, ==, info_b[i].codepoint);
+    g_assert_cmphex (info_a[i].cluster,   ==, info_b[i].cluster);
+    g_assert_cmphex (hb_glyph_info_get_glyph_flags (&info_a[i]), ==,
+		     hb_glyph_info_get_glyph_flags (&info_b[i]));
+    g_assert_cmpint (pos_a[i].x_advance, ==, pos_b[i].x_advance);
+    g_assert_cmpint (pos_a[i].y_advance, ==, pos_b[i].y_advance);
+    g_assert_cmpint (pos_a[i].x_offset,  ==, pos_b[i].x_offset);
+    g_assert_cmpint (pos_a[i].y_offset,  ==, pos_b[i].y_offset);
+  }
+}
+
+static void
+shape_with_cache (hb_shape_cache_t *cache, hb_font_t *font,
+		  const char *text, unsigned int cluster_offset)
+{
+  hb_buffer_t *cached = hb_buffer_create ();
+  hb_buffer_t *expected = hb_buffer_create ();
+  unsigned int i;
+
+  hb_buffer_set_content_type (cached, HB_BUFFER_CONTENT_TYPE_UNICODE);
+  hb_buffer_set_content_type (expected, HB_BUFFER_CONTENT_TYPE_UNICODE);
+  for (i = 0; text[i]; i++)
+  {
+    hb_buffer_add (cached, text[i], cluster_offset + i);
+    hb_buffer_add (expected, text[i], cluster_offset + i);
+  }
+  hb_buffer_guess_segment_properties (cached);
+  hb_buffer_guess_segment_properties (expected);
+
+  g_assert (hb_shape_cache_shape_full (cache, font, cached, NULL, 0, NULL));
+  hb_shape (font, expected, NULL, 0);
+
+  assert_buffers_equal (cached, expected);
+
+  hb_buffer_destroy (cached);
+  hb_buffer_destroy (expected);
+}
+
+static void
+test_shape_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/OpenSans-Regular.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_shape_cache_t *cache = hb_shape_cache_create (2);
+  unsigned int hits, misses;
+
+  shape_with_cache (cache, font, "fi AVAV", 0);
+  hb_shape_cache_get_stats (cache, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 1);
+
+  /* Same text at a different cluster offset is a hit. */
+  shape_with_cache (cache, font, "fi AVAV", 7);
+  hb_shape_cache_get_stats (cache, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 1);
+
+  /* Changing the font invalidates. */
+  hb_font_set_scale (font, 2048, 1024);
+  shape_with_cache (cache, font, "fi AVAV", 0);
+  hb_shape_cache_get_stats (cache, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 2);
+
+  /* Evicts the least-recently-used entry. */
+  shape_with_cache (cache, font, "Test", 0);
+  shape_with_cache (cache, font, "Wave", 0);
+  shape_with_cache (cache, font, "fi AVAV", 0);
+  hb_shape_cache_get_stats (cache, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 5);
+
+  shape_with_cache (cache, font, "Wave", 0);
+  hb_shape_cache_get_stats (cache, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 2);
+  g_assert_cmpuint (misses, ==, 5);
+
+  hb_shape_cache_clear (cache);
+  shape_with_cache (cache, font, "Wave", 0);
+  hb_shape_cache_get_stats (cache, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 2);
+  g_assert_cmpuint (misses, ==, 6);
+
+  /* The empty cache just shapes. */
+  shape_with_cache (hb_shape_cache_get_empty (), font, "Wave", 0);
+
+  hb_shape_cache_destroy (cache);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+test_shape_cache_rand (void)
+{
+  /* Every glyph of this font has alternates picked by the rand feature. */
+  hb_face_t *face = hb_test_open_font_file ("fonts/rand-alternates.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_shape_cache_t *cache = hb_shape_cache_create (16);
+  uint32_t cached_state = 1, expected_state = 1;
+  unsigned int i;
+
+  /* Shaping the same run again goes on with the random state the last
+   * run left, cached or not. */
+  for (i = 0; i < 4; i++)
+  {
+    hb_buffer_t *cached = hb_buffer_create ();
+    hb_buffer_t *expected = hb_buffer_create ();
+
+    hb_buffer_add_utf8 (cached, "TUV", -1, 0, -1);
+    hb_buffer_add_utf8 (expected, "TUV", -1, 0, -1);
+    hb_buffer_guess_segment_properties (cached);
+    hb_buffer_guess_segment_properties (expected);
+    hb_buffer_set_random_state (cached, cached_state);
+    hb_buffer_set_random_state (expected, expected_state);
+
+    g_assert (hb_shape_cache_shape_full (cache, font, cached, NULL, 0, NULL));
+    hb_shape (font, expected, NULL, 0);
+
+    assert_buffers_equal (cached, expected);
+    cached_state = hb_buffer_get_random_state (cached);
+    expected_state = hb_buffer_get_random_state (expected);
+    g_assert_cmpuint (cached_state, ==, expected_state);
+
+    hb_buffer_destroy (cached);
+    hb_buffer_destroy (expected);
+  }
+
+  /* Starting over from the first state replays the first result. */
+  {
+    hb_buffer_t *buffer = hb_buffer_create ();
+    unsigned int hits, misses;
+
+    hb_buffer_add_utf8 (buffer, "TUV", -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    g_assert (hb_shape_cache_shape_full (cache, font, buffer, NULL, 0, NULL));
+    hb_shape_cache_get_stats (cache, &hits, &misses);
+    g_assert_cmpuint (hits, ==, 1);
+    g_assert_cmpuint (misses, ==, 4);
+
+    hb_buffer_destroy (buffer);
+  }
+
+  hb_shape_cache_destroy (cache);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+test_shape_plan_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/OpenSans-Regular.ttf");
+  hb_segment_properties_t props = HB_SEGMENT_PROPERTIES_DEFAULT;
+  hb_feature_t feature = {HB_TAG ('l','i','g','a'), 0, 0, (unsigned) -1};
+  unsigned int hits, misses, evictions, plans;
+
+  props.direction = HB_DIRECTION_LTR;
+  props.script = HB_SCRIPT_LATIN;
+
+  hb_shape_plan_t *plan = hb_shape_plan_create_cached (face, &props, &feature, 1, NULL);
+  hb_shape_plan_t *again = hb_shape_plan_create_cached (face, &props, &feature, 1, NULL);
+  g_assert (plan == again);
+  hb_shape_plan_destroy (again);
+  hb_shape_plan_destroy (plan);
+
+  hb_shape_plan_get_cache_stats (face, &hits, &misses, &evictions, &plans);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 1);
+  g_assert_cmpuint (evictions, ==, 0);
+  g_assert_cmpuint (plans, ==, 1);
+
+  /* Many more distinct plans than fit evict older ones, and the latest
+   * plans are still found. */
+  for (unsigned i = 1; i <= 1000; i++)
+  {
+    feature.value = i;
+    hb_shape_plan_destroy (hb_shape_plan_create_cached (face, &props, &feature, 1, NULL));
+  }
+  hb_shape_plan_get_cache_stats (face, &hits, &misses, &evictions, &plans);
+  g_assert_cmpuint (misses, ==, 1001);
+  g_assert_cmpuint (evictions, >, 0);
+  g_assert_cmpuint (plans, <=, 256);
+  g_assert_cmpuint (plans + evictions, ==, misses);
+
+  hb_shape_plan_destroy (hb_shape_plan_create_cached (face, &props, &feature, 1, NULL));
+  hb_shape_plan_get_cache_stats (face, &hits, NULL, NULL, NULL);
+  g_assert_cmpuint (hits, ==, 2);
+
+  hb_shape_plan_get_cache_stats (hb_face_get_empty (), &hits, &misses, &evictions, &plans);
+  g_assert_cmpuint (hits + misses + evictions + plans, ==, 0);
+
+  hb_face_destroy (face);
+}
+
+static void
+test_shape_batch (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/OpenSans-Regular.ttf");
+  hb_font_t *font = hb_font_create (face);
+  const char *texts[] = {"fi", "", "AVAV", "Test", "\xd8\xb3\xd9\x84\xd8\xa7\xd9\x85"};
+  hb_buffer_t *batch[G_N_ELEMENTS (texts)];
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (texts); i++)
+  {
+    batch[i] = hb_buffer_create ();
+    hb_buffer_add_utf8 (batch[i], texts[i], -1, 0, -1);
+    hb_buffer_guess_segment_properties (batch[i]);
+  }
+
+  g_assert (hb_shape_batch (font, batch, G_N_ELEMENTS (texts), NULL, 0, NULL));
+
+  for (i = 0; i < G_N_ELEMENTS (texts); i++)
+  {
+    hb_buffer_t *expected = hb_buffer_create ();
+    hb_buffer_add_utf8 (expected, texts[i], -1, 0, -1);
+    hb_buffer_guess_segment_properties (expected);
+    hb_shape (font, expected, NULL, 0);
+
+    if (hb_buffer_get_length (expected))
+      assert_buffers_equal (batch[i], expected);
+    else
+      g_assert_cmpint (hb_buffer_get_length (batch[i]), ==, 0);
+
+    hb_buffer_destroy (expected);
+    hb_buffer_destroy (batch[i]);
+  }
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 
 static void
 test_shape_list (void)
@@ -200,6 +444,10 @@ main (int argc, char **argv)
 
   hb_test_add (test_shape);
   hb_test_add (test_shape_clusters);
+  hb_test_add (test_shape_cache);
+  hb_test_add (test_shape_cache_rand);
+  hb_test_add (test_shape_plan_cache);
+  hb_test_add (test_shape_batch);
   /* TODO test fallback shaper */
   /* TODO test shaper_full */
   hb_test_add (test_shape_list);
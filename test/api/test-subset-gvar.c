@@ -90,6 +90,71 @@ test_subset_gvar_retaingids (void)
   hb_face_destroy (face_ac);
 }
 
+typedef struct
+{
+  unsigned depth;
+  unsigned max_nested_tasks;
+} reverse_executor_t;
+
+/* Runs the tasks backwards on the calling thread, noting the most tasks
+ * a nested call (i.e. from a table task) was handed. */
+static void
+_reverse_executor (unsigned               num_tasks,
+		   hb_subset_task_func_t  task,
+		   void                  *task_data,
+		   void                  *user_data)
+{
+  reverse_executor_t *executor = (reverse_executor_t *) user_data;
+  if (executor->depth && num_tasks > executor->max_nested_tasks)
+    executor->max_nested_tasks = num_tasks;
+  executor->depth++;
+  for (unsigned i = num_tasks; i; i--)
+    task (i - 1, task_data);
+  executor->depth--;
+}
+
+static hb_face_t *
+_instance_gvar (hb_face_t *face, hb_subset_flags_t flags,
+		reverse_executor_t *executor)
+{
+  /* Keep all glyphs, more than one range of them for the glyph variations
+   * to be processed in parallel. */
+  hb_set_t *glyphs = hb_set_create ();
+  hb_set_add_range (glyphs, 0, hb_face_get_glyph_count (face) - 1);
+  hb_subset_input_t *input = hb_subset_test_create_input_from_glyphs (glyphs);
+  hb_set_destroy (glyphs);
+
+  hb_subset_input_set_flags (input, flags);
+  if (executor)
+    hb_subset_input_set_executor (input, _reverse_executor, executor);
+  g_assert (hb_subset_input_set_axis_range (input, face, HB_TAG ('w','g','h','t'), 300, 700, 400));
+
+  return hb_subset_test_create_subset (face, input);
+}
+
+static void
+test_instance_gvar_parallel (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Mada-VF.ttf");
+  g_assert_cmpuint (hb_face_get_glyph_count (face), >, 256);
+
+  hb_face_t *serial = _instance_gvar (face, HB_SUBSET_FLAGS_DEFAULT, NULL);
+  hb_face_t *parallel = _instance_gvar (face, HB_SUBSET_FLAGS_PARALLEL, NULL);
+  reverse_executor_t executor = {0, 0};
+  hb_face_t *reverse = _instance_gvar (face, HB_SUBSET_FLAGS_PARALLEL, &executor);
+  g_assert_cmpuint (executor.max_nested_tasks, >, 1);
+
+  hb_subset_test_check (serial, parallel, HB_TAG ('g','v','a','r'));
+  hb_subset_test_check (serial, parallel, HB_TAG ('g','l','y','f'));
+  hb_subset_test_check (serial, reverse, HB_TAG ('g','v','a','r'));
+  hb_subset_test_check (serial, reverse, HB_TAG ('g','l','y','f'));
+
+  hb_face_destroy (reverse);
+  hb_face_destroy (parallel);
+  hb_face_destroy (serial);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -98,6 +163,7 @@ main (int argc, char **argv)
   hb_test_add (test_subset_gvar_noop);
   hb_test_add (test_subset_gvar);
   hb_test_add (test_subset_gvar_retaingids);
+  hb_test_add (test_instance_gvar_parallel);
 
   return hb_test_run ();
 }
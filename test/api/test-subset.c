@@ -192,6 +192,153 @@ test_subset_plan (void)
   hb_face_destroy (face_ac);
 }
 
+static void
+test_subset_plan_incremental (void)
+{
+  hb_face_t *face_abc = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_face_t *face_ac = hb_test_open_font_file ("fonts/Roboto-Regular.ac.ttf");
+
+  hb_set_t *codepoints = hb_set_create();
+  hb_set_add (codepoints, 97);
+  hb_subset_input_t* input = hb_subset_test_create_input (codepoints);
+  hb_set_destroy (codepoints);
+
+  hb_subset_plan_t* plan_a = hb_subset_plan_create_or_fail (face_abc, input);
+  g_assert (plan_a);
+
+  hb_set_add (hb_subset_input_unicode_set (input), 99);
+  hb_subset_plan_t* plan = hb_subset_plan_create_incremental_or_fail (face_abc, input, plan_a);
+  g_assert (plan);
+
+  const hb_map_t* mapping = hb_subset_plan_old_to_new_glyph_mapping (plan);
+  g_assert (hb_map_get (mapping, 1) == 1);
+  g_assert (hb_map_get (mapping, 3) == 2);
+
+  hb_face_t* face_abc_subset = hb_subset_plan_execute_or_fail (plan);
+
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('l','o','c', 'a'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('g','l','y','f'));
+
+  hb_subset_input_destroy (input);
+  hb_subset_plan_destroy (plan_a);
+  hb_subset_plan_destroy (plan);
+  hb_face_destroy (face_abc_subset);
+  hb_face_destroy (face_abc);
+  hb_face_destroy (face_ac);
+}
+
+static hb_subset_input_t *
+_create_input_for_text (const char *text)
+{
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  for (const char *p = text; *p; p++)
+    hb_set_add (hb_subset_input_unicode_set (input), (unsigned char) *p);
+  return input;
+}
+
+/* Checks that a plan created incrementally from a plan for
+ * @previous_input matches one created from scratch for @input, and
+ * returns the latter's glyph mapping. */
+static hb_map_t *
+_check_incremental_plan (hb_face_t         *face,
+			 hb_subset_input_t *previous_input,
+			 hb_subset_input_t *input)
+{
+  hb_subset_plan_t *previous = hb_subset_plan_create_or_fail (face, previous_input);
+  g_assert (previous);
+  hb_subset_plan_t *incremental = hb_subset_plan_create_incremental_or_fail (face, input, previous);
+  g_assert (incremental);
+  hb_subset_plan_t *scratch = hb_subset_plan_create_or_fail (face, input);
+  g_assert (scratch);
+
+  const hb_map_t *mapping = hb_subset_plan_old_to_new_glyph_mapping (scratch);
+  g_assert (hb_map_is_equal (hb_subset_plan_old_to_new_glyph_mapping (incremental), mapping));
+
+  hb_face_t *incremental_subset = hb_subset_plan_execute_or_fail (incremental);
+  hb_face_t *scratch_subset = hb_subset_plan_execute_or_fail (scratch);
+  g_assert (incremental_subset);
+  g_assert (scratch_subset);
+  hb_blob_t *incremental_blob = hb_face_reference_blob (incremental_subset);
+  hb_blob_t *scratch_blob = hb_face_reference_blob (scratch_subset);
+  hb_test_assert_blobs_equal (scratch_blob, incremental_blob);
+
+  hb_map_t *ret = hb_map_copy (mapping);
+
+  hb_blob_destroy (incremental_blob);
+  hb_blob_destroy (scratch_blob);
+  hb_face_destroy (incremental_subset);
+  hb_face_destroy (scratch_subset);
+  hb_subset_plan_destroy (previous);
+  hb_subset_plan_destroy (incremental);
+  hb_subset_plan_destroy (scratch);
+  return ret;
+}
+
+static void
+test_subset_plan_incremental_closures (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/OpenSans-Regular.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_codepoint_t fi, ring;
+  g_assert (hb_font_get_glyph_from_name (font, "uniFB01", -1, &fi));
+  g_assert (hb_font_get_glyph_from_name (font, "ring", -1, &ring));
+  hb_font_destroy (font);
+
+  hb_subset_input_t *previous_input, *input;
+  hb_map_t *mapping;
+
+  /* The GSUB and composite glyph closures are seeded with the previous
+   * ones, and extended with the fi ligature and the ring of Aring. */
+  previous_input = _create_input_for_text ("fA");
+  input = _create_input_for_text ("fiA");
+  hb_set_add (hb_subset_input_unicode_set (input), 0x00C5u);
+  mapping = _check_incremental_plan (face, previous_input, input);
+  g_assert (hb_map_has (mapping, fi));
+  g_assert (hb_map_has (mapping, ring));
+  hb_map_destroy (mapping);
+  hb_subset_input_destroy (previous_input);
+  hb_subset_input_destroy (input);
+
+  /* The previous closures are not reused if the flags changed... */
+  previous_input = _create_input_for_text ("fi");
+  input = _create_input_for_text ("fiA");
+  hb_subset_input_set_flags (input, HB_SUBSET_FLAGS_NO_LAYOUT_CLOSURE);
+  mapping = _check_incremental_plan (face, previous_input, input);
+  g_assert (!hb_map_has (mapping, fi));
+  hb_map_destroy (mapping);
+  hb_subset_input_destroy (input);
+
+  /* ...if the dropped tables changed... */
+  input = _create_input_for_text ("fiA");
+  hb_set_add (hb_subset_input_set (input, HB_SUBSET_SETS_DROP_TABLE_TAG), HB_TAG ('G','S','U','B'));
+  mapping = _check_incremental_plan (face, previous_input, input);
+  g_assert (!hb_map_has (mapping, fi));
+  hb_map_destroy (mapping);
+  hb_subset_input_destroy (input);
+
+  /* ...if the layout features changed... */
+  input = _create_input_for_text ("fiA");
+  hb_set_clear (hb_subset_input_set (input, HB_SUBSET_SETS_LAYOUT_FEATURE_TAG));
+  mapping = _check_incremental_plan (face, previous_input, input);
+  g_assert (!hb_map_has (mapping, fi));
+  hb_map_destroy (mapping);
+  hb_subset_input_destroy (input);
+  hb_subset_input_destroy (previous_input);
+
+  /* ...or if the input is not a superset of the previous one. */
+  previous_input = _create_input_for_text ("fi");
+  hb_set_add (hb_subset_input_unicode_set (previous_input), 0x00C5u);
+  input = _create_input_for_text ("fA");
+  mapping = _check_incremental_plan (face, previous_input, input);
+  g_assert (!hb_map_has (mapping, fi));
+  g_assert (!hb_map_has (mapping, ring));
+  hb_map_destroy (mapping);
+  hb_subset_input_destroy (previous_input);
+  hb_subset_input_destroy (input);
+
+  hb_face_destroy (face);
+}
+
 static hb_blob_t*
 _ref_table (hb_face_t *face HB_UNUSED, hb_tag_t tag, void *user_data)
 {
@@ -228,6 +375,187 @@ test_subset_create_for_tables_face (void)
   hb_face_destroy (face_ac);
 }
 
+static void
+_count_and_run_tasks (unsigned int           num_tasks,
+		      hb_subset_task_func_t  task,
+		      void                  *task_data,
+		      void                  *user_data)
+{
+  unsigned *calls = (unsigned *) user_data;
+  (*calls)++;
+  /* Run in reverse to check that tasks don't depend on their order. */
+  for (unsigned i = num_tasks; i; i--)
+    task (i - 1, task_data);
+}
+
+static void
+test_subset_parallel (void)
+{
+  hb_face_t *face_abc = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_face_t *face_ac = hb_test_open_font_file ("fonts/Roboto-Regular.ac.ttf");
+
+  hb_set_t *codepoints = hb_set_create();
+  hb_set_add (codepoints, 97);
+  hb_set_add (codepoints, 99);
+
+  hb_subset_input_t* input = hb_subset_test_create_input (codepoints);
+  hb_set_destroy (codepoints);
+  hb_subset_input_set_flags (input, HB_SUBSET_FLAGS_PARALLEL);
+
+  hb_face_t* face_abc_subset = hb_subset_or_fail (face_abc, input);
+  g_assert (face_abc_subset);
+
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('l','o','c', 'a'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('g','l','y','f'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('h','m','t','x'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('c','m','a','p'));
+  hb_face_destroy (face_abc_subset);
+
+  unsigned calls = 0;
+  hb_subset_input_set_executor (input, _count_and_run_tasks, &calls);
+
+  face_abc_subset = hb_subset_or_fail (face_abc, input);
+  g_assert (face_abc_subset);
+  g_assert_cmpuint (calls, >, 0);
+
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('l','o','c', 'a'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('g','l','y','f'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('h','m','t','x'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('c','m','a','p'));
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face_abc_subset);
+  hb_face_destroy (face_abc);
+  hb_face_destroy (face_ac);
+}
+
+static void
+test_subset_preprocess_save_load (void)
+{
+  hb_face_t *face_abc = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_face_t *face_ac = hb_test_open_font_file ("fonts/Roboto-Regular.ac.ttf");
+
+  hb_face_t *preprocessed = hb_subset_preprocess (face_abc);
+  hb_blob_t *data = hb_subset_preprocess_save (preprocessed);
+  g_assert_cmpuint (hb_blob_get_length (data), >, 0);
+
+  hb_blob_t *font_data = hb_face_reference_blob (preprocessed);
+  hb_face_t *loaded = hb_face_create (font_data, 0);
+  hb_blob_destroy (font_data);
+
+  g_assert (!hb_subset_preprocess_load (loaded, hb_blob_get_empty ()));
+  g_assert (!hb_subset_preprocess_load (face_ac, data));
+  g_assert (hb_subset_preprocess_load (loaded, data));
+
+  hb_set_t *codepoints = hb_set_create();
+  hb_set_add (codepoints, 97);
+  hb_set_add (codepoints, 99);
+  hb_subset_input_t* input = hb_subset_test_create_input (codepoints);
+  hb_set_destroy (codepoints);
+
+  hb_face_t* face_abc_subset = hb_subset_or_fail (loaded, input);
+  g_assert (face_abc_subset);
+
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('l','o','c', 'a'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('g','l','y','f'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('h','m','t','x'));
+  hb_subset_test_check (face_ac, face_abc_subset, HB_TAG ('c','m','a','p'));
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face_abc_subset);
+  hb_face_destroy (loaded);
+  hb_blob_destroy (data);
+  hb_face_destroy (preprocessed);
+  hb_face_destroy (face_abc);
+  hb_face_destroy (face_ac);
+}
+
+typedef struct
+{
+  unsigned depth;
+  unsigned max_depth;
+  unsigned num_plan;
+  unsigned num_glyph_closure;
+  unsigned num_layout_closure;
+  unsigned num_tables;
+  unsigned glyf_bytes;
+  hb_bool_t out_of_order;
+} stage_counts_t;
+
+static void
+_count_stages (const hb_subset_stage_info_t *info,
+	       void                         *user_data)
+{
+  stage_counts_t *counts = (stage_counts_t *) user_data;
+
+  if (!info->end_ns)
+  {
+    counts->depth++;
+    if (counts->depth > counts->max_depth)
+      counts->max_depth = counts->depth;
+    return;
+  }
+
+  if (!counts->depth || info->end_ns < info->start_ns)
+    counts->out_of_order = TRUE;
+  counts->depth--;
+
+  switch (info->stage)
+  {
+  case HB_SUBSET_STAGE_PLAN: counts->num_plan++; break;
+  case HB_SUBSET_STAGE_GLYPH_CLOSURE: counts->num_glyph_closure++; break;
+  case HB_SUBSET_STAGE_LAYOUT_CLOSURE: counts->num_layout_closure++; break;
+  case HB_SUBSET_STAGE_TABLE:
+    counts->num_tables++;
+    if (info->table_tag == HB_TAG ('g','l','y','f'))
+      counts->glyf_bytes = info->bytes;
+    break;
+  default: break;
+  }
+}
+
+static void
+test_subset_stage_func (void)
+{
+  hb_face_t *face_abc = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_face_t *face_ac = hb_test_open_font_file ("fonts/Roboto-Regular.ac.ttf");
+
+  hb_set_t *codepoints = hb_set_create();
+  hb_set_add (codepoints, 97);
+  hb_set_add (codepoints, 99);
+  hb_subset_input_t* input = hb_subset_test_create_input (codepoints);
+  hb_set_destroy (codepoints);
+
+  stage_counts_t counts = {0};
+  hb_subset_input_set_stage_func (input, _count_stages, &counts);
+
+  hb_face_t* face_abc_subset = hb_subset_or_fail (face_abc, input);
+  g_assert (face_abc_subset);
+
+  g_assert (!counts.out_of_order);
+  g_assert_cmpuint (counts.depth, ==, 0);
+  g_assert_cmpuint (counts.max_depth, >=, 3);
+  g_assert_cmpuint (counts.num_plan, ==, 1);
+  g_assert_cmpuint (counts.num_glyph_closure, ==, 1);
+  g_assert_cmpuint (counts.num_layout_closure, ==, 2);
+  g_assert_cmpuint (counts.num_tables, >, 0);
+
+  hb_blob_t *glyf = hb_face_reference_table (face_ac, HB_TAG ('g','l','y','f'));
+  hb_blob_t *loca = hb_face_reference_table (face_ac, HB_TAG ('l','o','c','a'));
+  hb_blob_t *head = hb_face_reference_table (face_ac, HB_TAG ('h','e','a','d'));
+  g_assert_cmpuint (counts.glyf_bytes, ==, hb_blob_get_length (glyf) +
+					   hb_blob_get_length (loca) +
+					   hb_blob_get_length (head));
+  hb_blob_destroy (glyf);
+  hb_blob_destroy (loca);
+  hb_blob_destroy (head);
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face_abc_subset);
+  hb_face_destroy (face_abc);
+  hb_face_destroy (face_ac);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -239,7 +567,12 @@ main (int argc, char **argv)
   hb_test_add (test_subset_set_flags);
   hb_test_add (test_subset_sets);
   hb_test_add (test_subset_plan);
+  hb_test_add (test_subset_plan_incremental);
+  hb_test_add (test_subset_plan_incremental_closures);
   hb_test_add (test_subset_create_for_tables_face);
+  hb_test_add (test_subset_parallel);
+  hb_test_add (test_subset_preprocess_save_load);
+  hb_test_add (test_subset_stage_func);
 
   return hb_test_run();
 }
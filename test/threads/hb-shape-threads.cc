@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -105,6 +108,159 @@ static void shape (const test_input_t &input,
   hb_blob_destroy (text_blob);
 }
 
+/*
+ * Scaling benchmark.
+ *
+ * Instead of every thread shaping the whole text, the lines of the text
+ * are distributed across the threads: each worker owns a contiguous slice
+ * of the lines and consumes it front to back; once its own slice is done
+ * it steals remaining lines from the other workers' slices.  Each worker
+ * reuses a single buffer for all the lines it shapes, while the font, and
+ * with it the face tables and lookup accelerators, is shared.
+ *
+ * Shaping itself has no parallel entry point: unlike the subsetter, which
+ * starts its own threads for HB_SUBSET_FLAGS_PARALLEL, hb_shape() works on
+ * one buffer at a time, and it is up to the caller to spread buffers over
+ * threads, as done here.
+ */
+
+struct line_t
+{
+  const char *text;
+  unsigned length;
+};
+
+struct worker_queue_t
+{
+  std::atomic<unsigned> next;
+  unsigned end;
+};
+
+static bool steal (std::vector<worker_queue_t> &queues,
+		   unsigned self,
+		   unsigned *line)
+{
+  unsigned n = queues.size ();
+  for (unsigned i = 0; i < n; i++)
+  {
+    worker_queue_t &q = queues[(self + i) % n];
+    if (q.next.load (std::memory_order_relaxed) >= q.end)
+      continue;
+    unsigned l = q.next.fetch_add (1, std::memory_order_relaxed);
+    if (l < q.end)
+    {
+      *line = l;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void shape_worker (std::vector<worker_queue_t> *queues,
+			  unsigned self,
+			  const std::vector<line_t> *lines,
+			  hb_font_t *font,
+			  hb_language_t language,
+			  unsigned long long *num_glyphs)
+{
+  hb_buffer_t *buf = hb_buffer_create ();
+  unsigned long long glyphs = 0;
+  unsigned l;
+  while (steal (*queues, self, &l))
+  {
+    const line_t &line = (*lines)[l];
+    hb_buffer_clear_contents (buf);
+    hb_buffer_add_utf8 (buf, line.text, line.length, 0, line.length);
+    hb_buffer_guess_segment_properties (buf);
+    hb_buffer_set_language (buf, language);
+    hb_shape (font, buf, nullptr, 0);
+    glyphs += hb_buffer_get_length (buf);
+  }
+  hb_buffer_destroy (buf);
+  *num_glyphs = glyphs;
+}
+
+static unsigned long long shape_parallel (const std::vector<line_t> &lines,
+					  hb_font_t *font,
+					  hb_language_t language,
+					  unsigned n_threads)
+{
+  std::vector<worker_queue_t> queues (n_threads);
+  unsigned per_thread = (lines.size () + n_threads - 1) / n_threads;
+  for (unsigned i = 0; i < n_threads; i++)
+  {
+    unsigned start = std::min<size_t> (i * per_thread, lines.size ());
+    queues[i].next.store (start);
+    queues[i].end = std::min<size_t> (start + per_thread, lines.size ());
+  }
+
+  std::vector<unsigned long long> num_glyphs (n_threads);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < n_threads; i++)
+    threads.push_back (std::thread (shape_worker, &queues, i, &lines, font, language, &num_glyphs[i]));
+  for (unsigned i = 0; i < n_threads; i++)
+    threads[i].join ();
+
+  unsigned long long total = 0;
+  for (unsigned i = 0; i < n_threads; i++)
+    total += num_glyphs[i];
+  return total;
+}
+
+static void test_scaling (const test_input_t &input,
+			  hb_font_t *font)
+{
+  const char *lang_str = strrchr (input.text_path, '/');
+  lang_str = lang_str ? lang_str + 1 : input.text_path;
+  hb_language_t language = hb_language_from_string (lang_str, -1);
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  std::vector<line_t> lines;
+  for (unsigned i = 0; i < num_repetitions; i++)
+  {
+    const char *p = text;
+    unsigned length = text_length;
+    const char *end;
+    while ((end = (const char *) memchr (p, '\n', length)))
+    {
+      lines.push_back ({p, (unsigned) (end - p)});
+      unsigned skip = end - p + 1;
+      length -= skip;
+      p += skip;
+    }
+    /* Last line, if not terminated by a newline. */
+    if (length)
+      lines.push_back ({p, length});
+  }
+
+  /* Warm up the lazy-loaded tables so they don't count against one thread count. */
+  unsigned long long expected_glyphs = shape_parallel (lines, font, language, 1);
+
+  for (unsigned n = 1; ; n = std::min (n * 2, num_threads))
+  {
+    auto start = std::chrono::steady_clock::now ();
+    unsigned long long glyphs = shape_parallel (lines, font, language, n);
+    auto end = std::chrono::steady_clock::now ();
+    assert (glyphs == expected_glyphs);
+
+    double seconds = std::chrono::duration<double> (end - start).count ();
+    printf ("  %2u threads: %8.0f lines/s, %10.0f glyphs/s, %10.0f glyphs/s/thread\n",
+	    n,
+	    lines.size () / seconds,
+	    glyphs / seconds,
+	    glyphs / seconds / n);
+
+    if (n >= num_threads)
+      break;
+  }
+
+  hb_blob_destroy (text_blob);
+}
+
 static void test_backend (backend_t backend,
 			  const char *backend_name,
 			  bool variable,
@@ -166,6 +322,8 @@ static void test_backend (backend_t backend,
   for (unsigned i = 0; i < num_threads; i++)
     threads[i].join ();
 
+  test_scaling (test_input, font);
+
   hb_font_destroy (font);
 }
 